@@ -0,0 +1,30 @@
+#ifndef BENCH_CACHE_DIR_H
+#define BENCH_CACHE_DIR_H
+
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+/*
+    Points TTSCache at a fresh temporary directory (VOICEKIT_TTS_CACHE_DIR) and
+    removes it when the process exits, so a run neither leaves segment files in
+    the working directory nor starts from what an earlier run left behind.
+
+    Call before the first TTSCache::getInstance(): the handler is registered
+    first, so it runs after the cache singleton has been destroyed and its
+    writer thread has flushed.
+*/
+inline void useTemporaryCacheDir() {
+    static std::string directory;
+    std::string pattern = (std::filesystem::temp_directory_path() / "voicekit-bench-XXXXXX").string();
+    if (!mkdtemp(pattern.data())) throw std::runtime_error("Failed to create a temporary cache directory");
+    directory = pattern;
+    setenv("VOICEKIT_TTS_CACHE_DIR", directory.c_str(), 1);
+    std::atexit([] {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    });
+}
+
+#endif // BENCH_CACHE_DIR_H
@@ -0,0 +1,264 @@
+#include "MockVendorServers.h"
+#include "base64.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Value of `key` in the URI's query string, or "" if absent
+std::string queryValue(const std::string& uri, const std::string& key) {
+    size_t query = uri.find('?');
+    if (query == std::string::npos) return "";
+    size_t pos = query;
+    while (pos != std::string::npos && pos < uri.size()) {
+        size_t start = pos + 1;
+        size_t end = uri.find('&', start);
+        std::string pair = uri.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (pair.compare(0, key.size() + 1, key + "=") == 0) return pair.substr(key.size() + 1);
+        pos = end;
+    }
+    return "";
+}
+
+size_t bytesFor(std::chrono::milliseconds duration, int sampleRate) {
+    size_t bytes = static_cast<size_t>(duration.count()) * static_cast<size_t>(sampleRate) * 2 / 1000;
+    return bytes & ~size_t(1);
+}
+
+} // namespace
+
+MockVendorServers::MockVendorServers(const Options& options) : m_options(options) {}
+
+MockVendorServers::~MockVendorServers() {
+    Stop();
+}
+
+void MockVendorServers::Start() {
+    webSocketServer = std::make_unique<ix::WebSocketServer>(m_options.port, m_options.host);
+    webSocketServer->disablePerMessageDeflate();
+    webSocketServer->setOnClientMessageCallback(
+        [this](std::shared_ptr<ix::ConnectionState> state, ix::WebSocket& socket, const ix::WebSocketMessagePtr& msg) {
+            onMessage(state, socket, msg);
+        });
+    auto listening = webSocketServer->listen();
+    if (!listening.first) {
+        throw std::runtime_error("Mock WebSocket server cannot listen on port " + std::to_string(m_options.port) +
+                                 ": " + listening.second);
+    }
+
+    httpServer = std::make_unique<ix::HttpServer>(m_options.port + 1, m_options.host);
+    httpServer->setOnConnectionCallback([](ix::HttpRequestPtr request, std::shared_ptr<ix::ConnectionState>) {
+        if (request->uri.rfind("/v2/voices", 0) != 0) {
+            return std::make_shared<ix::HttpResponse>(404, "Not Found", ix::HttpErrorCode::Ok,
+                                                      ix::WebSocketHttpHeaders(), "");
+        }
+        json voices = {{"voices", json::array({{{"voice_id", "mock-voice"},
+                                                {"name", "Mock"},
+                                                {"high_quality_base_model_ids", json::array({"eleven_flash_v2_5"})}}})},
+                       {"total_count", 1}};
+        ix::WebSocketHttpHeaders headers;
+        headers["Content-Type"] = "application/json";
+        return std::make_shared<ix::HttpResponse>(200, "OK", ix::HttpErrorCode::Ok, headers, voices.dump());
+    });
+    listening = httpServer->listen();
+    if (!listening.first) {
+        throw std::runtime_error("Mock HTTP server cannot listen on port " + std::to_string(m_options.port + 1) +
+                                 ": " + listening.second);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopScheduler = false;
+    }
+    schedulerThread = std::thread(&MockVendorServers::runScheduler, this);
+    webSocketServer->start();
+    httpServer->start();
+}
+
+void MockVendorServers::Stop() {
+    if (webSocketServer) webSocketServer->stop();
+    if (httpServer) httpServer->stop();
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopScheduler = true;
+    }
+    jobsCV.notify_all();
+    if (schedulerThread.joinable()) schedulerThread.join();
+    webSocketServer.reset();
+    httpServer.reset();
+}
+
+std::string MockVendorServers::WebSocketUrl() const {
+    return "ws://" + m_options.host + ":" + std::to_string(m_options.port);
+}
+
+std::string MockVendorServers::HttpUrl() const {
+    return "http://" + m_options.host + ":" + std::to_string(m_options.port + 1);
+}
+
+void MockVendorServers::onMessage(const std::shared_ptr<ix::ConnectionState>& state, ix::WebSocket& socket,
+                                  const ix::WebSocketMessagePtr& msg) {
+    const std::string& id = state->getId();
+    if (msg->type == ix::WebSocketMessageType::Open) {
+        onOpen(id, socket, msg->openInfo.uri);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    if (msg->type == ix::WebSocketMessageType::Close) {
+        connections.erase(id);
+        return;
+    }
+    if (msg->type != ix::WebSocketMessageType::Message) return;
+
+    auto it = connections.find(id);
+    if (it == connections.end()) return;
+    switch (it->second.protocol) {
+    case Protocol::DeepgramListen: handleListen(id, it->second, msg); break;
+    case Protocol::DeepgramSpeak: handleSpeak(id, it->second, msg->str); break;
+    case Protocol::ElevenlabsStream: handleStreamInput(id, it->second, msg->str); break;
+    case Protocol::Unknown: break;
+    }
+}
+
+void MockVendorServers::onOpen(const std::string& id, ix::WebSocket& socket, const std::string& uri) {
+    Connection connection;
+    connection.socket = &socket;
+    if (uri.rfind("/v1/listen", 0) == 0) {
+        connection.protocol = Protocol::DeepgramListen;
+        std::string rate = queryValue(uri, "sample_rate");
+        if (!rate.empty()) connection.sampleRate = std::stoi(rate);
+    } else if (uri.rfind("/v1/speak", 0) == 0) {
+        connection.protocol = Protocol::DeepgramSpeak;
+        std::string rate = queryValue(uri, "sample_rate");
+        if (!rate.empty()) connection.sampleRate = std::stoi(rate);
+    } else if (uri.rfind("/v1/text-to-speech/", 0) == 0 && uri.find("/stream-input") != std::string::npos) {
+        connection.protocol = Protocol::ElevenlabsStream;
+        std::string format = queryValue(uri, "output_format");  // pcm_16000
+        if (format.rfind("pcm_", 0) == 0) connection.sampleRate = std::stoi(format.substr(4));
+    }
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    connections[id] = connection;
+}
+
+void MockVendorServers::handleListen(const std::string& id, Connection& connection,
+                                     const ix::WebSocketMessagePtr& msg) {
+    if (!msg->binary) return;  // KeepAlive, CloseStream
+    if (msg->str.size() >= sizeof(uint32_t)) {
+        std::memcpy(&connection.lastFrame, msg->str.data(), sizeof(uint32_t));
+    }
+    connection.utteranceBytes += msg->str.size();
+
+    size_t perUtterance = bytesFor(m_options.utterance, connection.sampleRate);
+    if (perUtterance == 0 || connection.utteranceBytes < perUtterance) return;
+    connection.utteranceBytes -= perUtterance;
+
+    json result = {{"type", "Results"},
+                   {"is_final", true},
+                   {"speech_final", true},
+                   {"channel",
+                    {{"alternatives",
+                      json::array({{{"transcript", "frame " + std::to_string(connection.lastFrame)},
+                                    {"confidence", 0.99}}})}}}};
+    schedule({std::chrono::steady_clock::now() + m_options.latency, id, connection.generation, result.dump(), false});
+}
+
+void MockVendorServers::handleSpeak(const std::string& id, Connection& connection, const std::string& message) {
+    auto parsed = json::parse(message, nullptr, false);
+    if (parsed.is_discarded() || !parsed.contains("type")) return;
+    std::string type = parsed["type"];
+
+    if (type == "Speak") {
+        connection.pendingText += parsed.value("text", "");
+    } else if (type == "Flush") {
+        scheduleSpeech(id, connection, connection.pendingText, json{{"type", "Flushed"}, {"sequence_id", 0}}.dump());
+        connection.pendingText.clear();
+    } else if (type == "Clear") {
+        ++connection.generation;
+        connection.pendingText.clear();
+        schedule({std::chrono::steady_clock::now(), id, connection.generation,
+                  json{{"type", "Cleared"}, {"sequence_id", 0}}.dump(), false});
+    }
+}
+
+void MockVendorServers::handleStreamInput(const std::string& id, Connection& connection, const std::string& message) {
+    auto parsed = json::parse(message, nullptr, false);
+    if (parsed.is_discarded() || !parsed.contains("text")) return;
+    if (parsed.contains("voice_settings")) return;  // initial settings message
+
+    std::string text = parsed.value("text", "");
+    if (!text.empty()) {
+        connection.pendingText += text;
+        return;
+    }
+    // Empty text ends the input
+    scheduleSpeech(id, connection, connection.pendingText, json{{"isFinal", true}}.dump());
+    connection.pendingText.clear();
+}
+
+void MockVendorServers::scheduleSpeech(const std::string& id, const Connection& connection, const std::string& text,
+                                       const std::string& finalMessage) {
+    size_t total = bytesFor(m_options.perCharacter * static_cast<int>(text.size()), connection.sampleRate);
+    size_t chunkBytes = std::max<size_t>(2, bytesFor(m_options.chunk, connection.sampleRate));
+
+    // Quiet square wave, so nothing downstream mistakes it for silence
+    std::vector<uint8_t> pcm(chunkBytes);
+    for (size_t i = 0; i + 1 < pcm.size(); i += 2) {
+        int16_t sample = (i / 2) % 40 < 20 ? 64 : -64;
+        std::memcpy(&pcm[i], &sample, sizeof(sample));
+    }
+
+    auto due = std::chrono::steady_clock::now() + m_options.latency;
+    for (size_t sent = 0; sent < total; sent += chunkBytes) {
+        size_t size = std::min(chunkBytes, total - sent);
+        if (connection.protocol == Protocol::ElevenlabsStream) {
+            json chunk = {{"audio", siprtc::base64_encode(pcm.data(), size)}, {"isFinal", nullptr}};
+            schedule({due, id, connection.generation, chunk.dump(), false});
+        } else {
+            schedule({due, id, connection.generation, std::string(pcm.begin(), pcm.begin() + size), true});
+        }
+        due += m_options.chunkInterval;
+    }
+    schedule({due, id, connection.generation, finalMessage, false});
+}
+
+void MockVendorServers::schedule(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push(std::move(job));
+    }
+    jobsCV.notify_one();
+}
+
+void MockVendorServers::runScheduler() {
+    pthread_setname_np(pthread_self(), "MockVendorSend");
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    while (!stopScheduler) {
+        if (jobs.empty()) {
+            jobsCV.wait(lock);
+            continue;
+        }
+        auto due = jobs.top().due;
+        if (due > std::chrono::steady_clock::now()) {
+            jobsCV.wait_until(lock, due);
+            continue;
+        }
+        Job job = jobs.top();
+        jobs.pop();
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> connectionsLock(connectionsMutex);
+            auto it = connections.find(job.connection);
+            if (it != connections.end() && it->second.generation == job.generation) {
+                it->second.socket->send(job.payload, job.binary);
+            }
+        }
+        lock.lock();
+    }
+}
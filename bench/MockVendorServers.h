@@ -0,0 +1,102 @@
+#ifndef MOCK_VENDOR_SERVERS_H
+#define MOCK_VENDOR_SERVERS_H
+
+#include <ixwebsocket/IXHttpServer.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Local stand-ins for the vendor services, for load tests. One WebSocket
+    server answers Deepgram listen (/v1/listen) and speak (/v1/speak) and
+    ElevenLabs stream-input (/v1/text-to-speech/<voice>/stream-input) by path;
+    an HTTP server on port + 1 answers the ElevenLabs voice lookup. Point the
+    modules at them through the VendorEndpoints environment variables.
+
+    Responses are synthetic. Listen returns one final transcript per
+    `utterance` of audio received, naming the sequence number found in the
+    first four bytes of the last frame so the client can time it. Speak and
+    stream-input return low-level PCM sized to the text (`perCharacter` of
+    audio per character), `chunk` at a time, `chunkInterval` apart, starting
+    `latency` after the request.
+*/
+class MockVendorServers {
+public:
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 18080;
+        std::chrono::milliseconds latency{150};       // request until the first transcript or audio
+        std::chrono::milliseconds chunk{100};         // audio per TTS message
+        std::chrono::milliseconds chunkInterval{25};  // between TTS messages
+        std::chrono::milliseconds utterance{2000};    // STT audio per final transcript
+        std::chrono::milliseconds perCharacter{50};   // TTS audio per character of text
+    };
+
+    explicit MockVendorServers(const Options& options);
+    ~MockVendorServers();
+
+    // Throws std::runtime_error if either port cannot be bound
+    void Start();
+    void Stop();
+
+    std::string WebSocketUrl() const;  // ws://host:port
+    std::string HttpUrl() const;       // http://host:port+1
+
+private:
+    enum class Protocol { Unknown, DeepgramListen, DeepgramSpeak, ElevenlabsStream };
+
+    struct Connection {
+        Protocol protocol = Protocol::Unknown;
+        ix::WebSocket* socket = nullptr;
+        int sampleRate = 16000;
+        size_t utteranceBytes = 0;  // audio received towards the next transcript
+        uint32_t lastFrame = 0;
+        std::string pendingText;
+        uint64_t generation = 0;    // bumped by Clear; queued audio of older generations is dropped
+    };
+
+    // A message due on a connection at a later time
+    struct Job {
+        std::chrono::steady_clock::time_point due;
+        std::string connection;
+        uint64_t generation;
+        std::string payload;
+        bool binary;
+        bool operator>(const Job& other) const { return due > other.due; }
+    };
+
+    void onMessage(const std::shared_ptr<ix::ConnectionState>& state, ix::WebSocket& socket,
+                   const ix::WebSocketMessagePtr& msg);
+    void onOpen(const std::string& id, ix::WebSocket& socket, const std::string& uri);
+    void handleListen(const std::string& id, Connection& connection, const ix::WebSocketMessagePtr& msg);
+    void handleSpeak(const std::string& id, Connection& connection, const std::string& message);
+    void handleStreamInput(const std::string& id, Connection& connection, const std::string& message);
+    // Queues audio for `text` and then `finalMessage`; callers hold connectionsMutex
+    void scheduleSpeech(const std::string& id, const Connection& connection, const std::string& text,
+                        const std::string& finalMessage);
+    void schedule(Job job);
+    void runScheduler();
+
+    Options m_options;
+    std::unique_ptr<ix::WebSocketServer> webSocketServer;
+    std::unique_ptr<ix::HttpServer> httpServer;
+
+    std::mutex connectionsMutex;
+    std::map<std::string, Connection> connections;
+
+    std::mutex jobsMutex;
+    std::condition_variable jobsCV;
+    std::priority_queue<Job, std::vector<Job>, std::greater<Job>> jobs;
+    bool stopScheduler = false;
+    std::thread schedulerThread;
+};
+
+#endif // MOCK_VENDOR_SERVERS_H
@@ -0,0 +1,83 @@
+#include "Base64Decoder.h"
+#include "base64.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compares siprtc::base64_decode with each Base64Decoder kernel on payload sizes
+// typical of ElevenLabs audio chunks. Reports throughput in MB/s of encoded input.
+
+static std::string makePayload(size_t rawBytes, std::mt19937& rng) {
+    std::vector<unsigned char> raw(rawBytes);
+    for (auto& b : raw) b = static_cast<unsigned char>(rng());
+    return siprtc::base64_encode(raw.data(), raw.size());
+}
+
+template <typename Fn>
+static double measureMBps(const std::string& encoded, Fn&& fn) {
+    // Repeat until ~64 MB of input has been processed so small payloads get stable numbers.
+    size_t iterations = std::max<size_t>(1, (64u << 20) / std::max<size_t>(1, encoded.size()));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (static_cast<double>(encoded.size()) * iterations) / (1024.0 * 1024.0) / seconds;
+}
+
+static bool verify(std::mt19937& rng) {
+    // Every length from 0..512 exercises all tail/padding paths of each kernel.
+    for (size_t n = 0; n <= 512; ++n) {
+        std::string encoded = makePayload(n, rng);
+        std::string expected = siprtc::base64_decode(encoded);
+        for (auto kernel : {Base64Decoder::Kernel::Scalar, Base64Decoder::Kernel::SSE41, Base64Decoder::Kernel::AVX2}) {
+            if (!Base64Decoder::isSupported(kernel)) continue;
+            std::vector<uint8_t> out(Base64Decoder::maxDecodedSize(encoded.size()));
+            ptrdiff_t written = Base64Decoder::decode(encoded.data(), encoded.size(), out.data(), kernel);
+            if (written != static_cast<ptrdiff_t>(expected.size()) ||
+                std::memcmp(expected.data(), out.data(), expected.size()) != 0) {
+                std::cerr << "Mismatch: kernel=" << Base64Decoder::kernelName(kernel) << " bytes=" << n << "\n";
+                return false;
+            }
+        }
+    }
+
+    std::string corrupt = makePayload(300, rng);
+    corrupt[150] = '*';
+    std::vector<uint8_t> out(Base64Decoder::maxDecodedSize(corrupt.size()));
+    if (Base64Decoder::decode(corrupt.data(), corrupt.size(), out.data()) != -1) {
+        std::cerr << "Invalid input was accepted\n";
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937 rng(42);
+    if (!verify(rng)) return EXIT_FAILURE;
+
+    std::cout << "best kernel: " << Base64Decoder::kernelName(Base64Decoder::bestKernel()) << "\n";
+    std::cout << "payload_bytes,implementation,mb_per_s\n";
+
+    for (size_t rawBytes : {640u, 16000u, 64000u, 1u << 20}) {
+        std::string encoded = makePayload(rawBytes, rng);
+        std::vector<uint8_t> out(Base64Decoder::maxDecodedSize(encoded.size()));
+        volatile size_t sink = 0;
+
+        double baseline = measureMBps(encoded, [&] { sink = sink + siprtc::base64_decode(encoded).size(); });
+        std::cout << rawBytes << ",siprtc," << baseline << "\n";
+
+        for (auto kernel : {Base64Decoder::Kernel::Scalar, Base64Decoder::Kernel::SSE41, Base64Decoder::Kernel::AVX2}) {
+            if (!Base64Decoder::isSupported(kernel)) continue;
+            double mbps = measureMBps(encoded, [&] {
+                sink = sink + static_cast<size_t>(Base64Decoder::decode(encoded.data(), encoded.size(), out.data(), kernel));
+            });
+            std::cout << rawBytes << "," << Base64Decoder::kernelName(kernel) << "," << mbps << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
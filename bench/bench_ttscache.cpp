@@ -0,0 +1,173 @@
+#include "BenchCacheDir.h"
+#include "TTSCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <openssl/sha.h>
+
+// Multi-threaded throughput of TTSCache lookups. Each thread runs a mix of memory hits
+// (hot keys), misses (unknown keys) and occasional saves, like concurrent TTS sessions.
+// Also times key generation and replays prompts to compare hit ratios per normalization setting;
+// pass a file with one prompt per line to replay real traffic instead of the built-in variants.
+
+static constexpr size_t kHotKeys = 64;
+static constexpr size_t kAudioBytes = 16000; // ~1 s of 8 kHz 16-bit audio
+static constexpr auto kDuration = std::chrono::milliseconds(1000);
+
+static std::vector<std::string> makeKeys(const std::string& prefix, size_t count) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(TTSCache::generateKey("bench", prefix, "pcm_s16le", 8000, "phrase " + std::to_string(i)));
+    }
+    return keys;
+}
+
+// The key function used before 128-bit keys, kept here as the baseline
+static std::string sha256Key(const std::string& vendor, const std::string& voiceName, const std::string& text) {
+    std::string input = vendor + voiceName + text;
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(input.c_str()), input.length(), hash);
+    std::stringstream ss;
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+    }
+    return ss.str();
+}
+
+static std::vector<std::string> loadPrompts(int argc, char** argv) {
+    std::vector<std::string> prompts;
+    if (argc > 1) {
+        std::ifstream file(argv[1]);
+        for (std::string line; std::getline(file, line);) prompts.push_back(line);
+        return prompts;
+    }
+    // Spelling variants of the same sentence, as LLM output produces them
+    const char* variants[] = {"%s", "%s ", " %s", "%s\n"};
+    for (int i = 0; i < 200; ++i) {
+        std::string base = "Your appointment number " + std::to_string(i) + " is confirmed.";
+        std::string upper = "Your Appointment Number " + std::to_string(i) + " is confirmed.";
+        std::string spaced = "Your appointment  number " + std::to_string(i) + " is confirmed";
+        for (const std::string& text : {base, upper, spaced}) {
+            for (const char* variant : variants) {
+                char buffer[128];
+                std::snprintf(buffer, sizeof(buffer), variant, text.c_str());
+                prompts.push_back(buffer);
+            }
+        }
+    }
+    return prompts;
+}
+
+static volatile size_t keySink = 0; // keeps the timed loops from being optimised away
+
+static void benchKeys(const std::vector<std::string>& prompts) {
+    std::cout << "\nkey_function,ns_per_key\n";
+    auto time = [&](const char* name, auto&& keyFor) {
+        size_t sink = 0, rounds = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r) {
+            for (const auto& text : prompts) sink += keyFor(text).size();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        keySink += sink;
+        std::cout << name << "," << ns / (rounds * prompts.size()) << "\n";
+    };
+    time("sha256_stringstream", [](const std::string& text) { return sha256Key("bench", "voice", text); });
+    time("murmur3_128", [](const std::string& text) {
+        return TTSCache::generateKey("bench", "voice", "pcm_s16le", 8000, text);
+    });
+    TTSCache::TextNormalization rules;
+    time("murmur3_128_normalized", [&](const std::string& text) {
+        return TTSCache::generateKey("bench", "voice", "pcm_s16le", 8000, TTSCache::normalizeText(text, rules));
+    });
+}
+
+// Replays the prompts against an empty key set: the first occurrence of a key misses, repeats hit
+static void benchNormalization(const std::vector<std::string>& prompts) {
+    struct Setting {
+        const char* name;
+        TTSCache::TextNormalization rules;
+    };
+    const Setting settings[] = {
+        {"none", {false, false, false}},
+        {"whitespace", {true, false, false}},
+        {"whitespace+case", {true, true, false}},
+        {"whitespace+case+punctuation", {true, true, true}},
+    };
+    std::cout << "\nnormalization,hit_ratio\n";
+    for (const auto& setting : settings) {
+        std::unordered_set<std::string> seen;
+        size_t hits = 0;
+        for (const auto& text : prompts) {
+            std::string key = TTSCache::generateKey("bench", "voice", "pcm_s16le", 8000,
+                                                    TTSCache::normalizeText(text, setting.rules));
+            if (!seen.insert(key).second) ++hits;
+        }
+        std::cout << setting.name << "," << static_cast<double>(hits) / prompts.size() << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    useTemporaryCacheDir();
+    TTSCache& cache = TTSCache::getInstance();
+    std::vector<uint8_t> audio(kAudioBytes, 0x55);
+    std::vector<std::string> hotKeys = makeKeys("hot", kHotKeys);
+    std::vector<std::string> coldKeys = makeKeys("cold", 4096);
+
+    for (const auto& key : hotKeys) cache.saveToCache(key, audio);
+
+    std::cout << "threads,ops_per_s,hits,misses\n";
+    for (size_t threads : {1u, 2u, 4u, 8u, 16u}) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> totalOps{0}, totalHits{0}, totalMisses{0};
+        std::vector<std::thread> workers;
+
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(static_cast<unsigned>(t + 1));
+                uint64_t ops = 0, hits = 0, misses = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    unsigned roll = rng() % 100;
+                    if (roll < 90) {
+                        // Hot phrase lookup, the ProcessText hit path
+                        const auto& key = hotKeys[rng() % hotKeys.size()];
+                        if (!cache.getCachedAudio(key).empty()) ++hits;
+                    } else if (roll < 99) {
+                        // New LLM sentence: miss
+                        if (cache.getCachedAudio(coldKeys[rng() % coldKeys.size()]).empty()) ++misses;
+                    } else {
+                        cache.saveToCache(hotKeys[rng() % hotKeys.size()], audio);
+                    }
+                    ++ops;
+                }
+                totalOps += ops;
+                totalHits += hits;
+                totalMisses += misses;
+            });
+        }
+
+        std::this_thread::sleep_for(kDuration);
+        stop = true;
+        for (auto& w : workers) w.join();
+
+        double seconds = std::chrono::duration<double>(kDuration).count();
+        std::cout << threads << "," << static_cast<uint64_t>(totalOps / seconds) << ","
+                  << totalHits << "," << totalMisses << "\n";
+    }
+
+    std::vector<std::string> prompts = loadPrompts(argc, argv);
+    benchKeys(prompts);
+    benchNormalization(prompts);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,350 @@
+#include "Base64Decoder.h"
+#include "BenchCacheDir.h"
+#include "STTModuleBase.h"
+#include "TTSCache.h"
+#include "TTSModuleBase.h"
+#include "base64.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Microbenchmarks of the CPU-bound hot paths, run in isolation: no credentials, no network,
+// no real-time pacing. Prints one JSON document so CI can archive each run and diff it
+// against the previous one.
+//
+//   voicekit_bench [--filter <substring>] [--min-time-ms <ms>] [--output <file>]
+//
+// Each result carries ns_per_op and ops_per_s; cases that move bytes also report mb_per_s.
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Options {
+    std::string filter;
+    std::chrono::milliseconds minTime{300};
+    std::string output;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    size_t bytesPerOp = 0;
+    int threads = 1;
+};
+
+volatile size_t benchSink = 0; // keeps the timed loops from being optimised away
+
+class Runner {
+public:
+    explicit Runner(const Options& options) : m_options(options) {}
+
+    bool selected(const std::string& name) const {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+    }
+
+    // Runs `op` in doubling batches until a batch takes at least the minimum time
+    void run(const std::string& name, size_t bytesPerOp, const std::function<void()>& op) {
+        if (!selected(name)) return;
+        op(); // warm-up: first-touch allocations, lazy init
+        for (uint64_t batch = 1;; batch *= 2) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < batch; ++i) op();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed >= m_options.minTime || batch >= (uint64_t(1) << 40)) {
+                add({name, batch, elapsed.count() / batch, bytesPerOp, 1});
+                return;
+            }
+        }
+    }
+
+    // For cases that time themselves, e.g. multi-threaded throughput
+    void add(const Result& result) {
+        std::cerr << result.name << ": " << result.nsPerOp << " ns/op\n";
+        m_results.push_back(result);
+    }
+
+    std::chrono::milliseconds minTime() const { return m_options.minTime; }
+
+    json report() const {
+        json results = json::array();
+        for (const auto& r : m_results) {
+            json entry = {{"name", r.name},
+                          {"iterations", r.iterations},
+                          {"threads", r.threads},
+                          {"ns_per_op", r.nsPerOp},
+                          {"ops_per_s", r.nsPerOp > 0 ? r.threads * 1e9 / r.nsPerOp : 0.0}};
+            if (r.bytesPerOp) entry["mb_per_s"] = r.threads * r.bytesPerOp / r.nsPerOp * 1e9 / (1024.0 * 1024.0);
+            results.push_back(entry);
+        }
+        return {{"schema", 1},
+                {"timestamp", std::chrono::duration_cast<std::chrono::seconds>(
+                                  std::chrono::system_clock::now().time_since_epoch()).count()},
+                {"hardware_threads", std::thread::hardware_concurrency()},
+                {"base64_kernel", Base64Decoder::kernelName(Base64Decoder::bestKernel())},
+                {"min_time_ms", m_options.minTime.count()},
+                {"results", results}};
+    }
+
+private:
+    Options m_options;
+    std::vector<Result> m_results;
+};
+
+// Vendor that never synthesises, exposing the base class paths under test
+class BenchTTS : public TTSModuleBase {
+public:
+    explicit BenchTTS(std::function<void(const std::vector<uint8_t>&)> cb)
+        : TTSModuleBase("bench", std::move(cb), "bench-voice") {
+        m_pacePlayout = false;
+    }
+
+    std::vector<std::string> Split(const std::string& text) { return splitText(text); }
+    void Play(const std::vector<uint8_t>& audio) { PlayAudioBuffer(audio); }
+    void SetRate(int sampleRate) { m_outputSampleRate = sampleRate; }
+
+    bool Initialise(const std::string&, const std::string&) override { return true; }
+    const char* VendorName() const override { return "bench"; }
+
+protected:
+    void ImplSynthesiseVoice(const std::string&, const std::string&) override {}
+};
+
+// Vendor that counts the audio the processing thread hands over
+class BenchSTT : public STTModuleBase {
+public:
+    BenchSTT() : STTModuleBase("bench", [](std::string&) {}, "en-US") {}
+
+    std::atomic<uint64_t> delivered{0};
+
+    void InitialiseSTTModule(const std::string&, const std::string&) override {}
+    const char* VendorName() const override { return "bench"; }
+
+protected:
+    void ImplStreamAudioData(std::vector<uint8_t> audioData) override {
+        benchSink = benchSink + audioData.size();
+        delivered.fetch_add(1, std::memory_order_release);
+    }
+    void ImplStartRecognition() override {}
+    void ImplStopRecognition() override {}
+    void ImplRecognize() override {}
+};
+
+std::string makeSentences(size_t count) {
+    const char* sentences[] = {"Thank you for calling, how can I help you today? ",
+                               "Your appointment is confirmed for Tuesday at 3 pm. ",
+                               "Please hold, I am transferring you now! ",
+                               "The balance on your account is 42 dollars and 17 cents. "};
+    std::string text;
+    for (size_t i = 0; i < count; ++i) text += sentences[i % 4];
+    return text;
+}
+
+std::string makeBase64(size_t rawBytes, std::mt19937& rng) {
+    std::vector<unsigned char> raw(rawBytes);
+    for (auto& b : raw) b = static_cast<unsigned char>(rng());
+    return siprtc::base64_encode(raw.data(), raw.size());
+}
+
+void benchSplitText(Runner& runner) {
+    BenchTTS tts([](const std::vector<uint8_t>&) {});
+    for (size_t sentences : {1u, 8u, 64u}) {
+        std::string text = makeSentences(sentences);
+        runner.run("split_text/sentences=" + std::to_string(sentences), text.size(),
+                   [&] { benchSink = benchSink + tts.Split(text).size(); });
+    }
+}
+
+void benchGenerateKey(Runner& runner) {
+    TTSCache::TextNormalization rules;
+    for (size_t sentences : {1u, 8u}) {
+        std::string text = makeSentences(sentences);
+        runner.run("generate_key/sentences=" + std::to_string(sentences), text.size(), [&] {
+            benchSink = benchSink + TTSCache::generateKey("bench", "bench-voice", "pcm_s16le", 8000, text).size();
+        });
+        runner.run("generate_key_normalized/sentences=" + std::to_string(sentences), text.size(), [&] {
+            benchSink = benchSink + TTSCache::generateKey("bench", "bench-voice", "pcm_s16le", 8000,
+                                                          TTSCache::normalizeText(text, rules)).size();
+        });
+    }
+}
+
+// Concurrent sessions: 90% hot-phrase hits, 9% misses, 1% saves of a hot phrase
+void benchCacheContention(Runner& runner) {
+    TTSCache& cache = TTSCache::getInstance();
+    std::vector<uint8_t> audio(16000, 0x55); // ~1 s of 8 kHz 16-bit audio
+    std::vector<std::string> hotKeys, coldKeys;
+    for (size_t i = 0; i < 64; ++i) {
+        hotKeys.push_back(TTSCache::generateKey("bench", "hot", "pcm_s16le", 8000, "phrase " + std::to_string(i)));
+    }
+    for (size_t i = 0; i < 4096; ++i) {
+        coldKeys.push_back(TTSCache::generateKey("bench", "cold", "pcm_s16le", 8000, "phrase " + std::to_string(i)));
+    }
+    for (const auto& key : hotKeys) cache.saveToCache(key, audio);
+
+    for (int threads : {1, 4, 16}) {
+        std::string name = "cache_get_save/threads=" + std::to_string(threads);
+        if (!runner.selected(name)) continue;
+
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> totalOps{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(static_cast<unsigned>(t + 1));
+                uint64_t ops = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    unsigned roll = rng() % 100;
+                    if (roll < 90) {
+                        benchSink = benchSink + cache.getCachedAudio(hotKeys[rng() % hotKeys.size()]).size();
+                    } else if (roll < 99) {
+                        benchSink = benchSink + cache.getCachedAudio(coldKeys[rng() % coldKeys.size()]).size();
+                    } else {
+                        cache.saveToCache(hotKeys[rng() % hotKeys.size()], audio);
+                    }
+                    ++ops;
+                }
+                totalOps += ops;
+            });
+        }
+        std::this_thread::sleep_for(runner.minTime());
+        stop = true;
+        for (auto& worker : workers) worker.join();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        uint64_t ops = std::max<uint64_t>(1, totalOps.load());
+        // Per-thread latency of one operation; ops_per_s scales it back up by the thread count
+        runner.add({name, ops, elapsed.count() * threads / ops, 0, threads});
+    }
+}
+
+void benchBase64(Runner& runner) {
+    std::mt19937 rng(42);
+    for (size_t rawBytes : {640u, 16000u, 64000u}) {
+        std::string encoded = makeBase64(rawBytes, rng);
+        std::string suffix = "/bytes=" + std::to_string(rawBytes);
+        runner.run("base64_decode/siprtc" + suffix, encoded.size(),
+                   [&] { benchSink = benchSink + siprtc::base64_decode(encoded).size(); });
+
+        std::vector<uint8_t> out(Base64Decoder::maxDecodedSize(encoded.size()));
+        runner.run("base64_decode/decoder" + suffix, encoded.size(), [&] {
+            benchSink = benchSink + static_cast<size_t>(Base64Decoder::decode(encoded.data(), encoded.size(), out.data()));
+        });
+    }
+}
+
+// Slicing one second of audio into 20 ms frames and handing them to the session callback
+void benchPlayout(Runner& runner) {
+    size_t frames = 0;
+    BenchTTS tts([&](const std::vector<uint8_t>& chunk) { frames += !chunk.empty(); });
+    for (int sampleRate : {8000, 16000, 24000}) {
+        tts.SetRate(sampleRate);
+        std::vector<uint8_t> audio(static_cast<size_t>(sampleRate) * 2, 0x55);
+        runner.run("play_audio_buffer/rate=" + std::to_string(sampleRate), audio.size(), [&] { tts.Play(audio); });
+    }
+    benchSink = benchSink + frames;
+}
+
+// StreamAudioData() through the processing thread to the vendor, one 20 ms frame per op
+void benchSTTQueue(Runner& runner) {
+    BenchSTT stt;
+    std::vector<uint8_t> frame(320, 0x55);
+    const uint64_t burst = 256;
+    runner.run("stt_queue/frames=" + std::to_string(burst), frame.size() * burst, [&] {
+        uint64_t target = stt.delivered.load(std::memory_order_acquire) + burst;
+        for (uint64_t i = 0; i < burst; ++i) stt.StreamAudioData(frame);
+        while (stt.delivered.load(std::memory_order_acquire) < target) std::this_thread::yield();
+    });
+}
+
+// The vendor message handlers' parsing work, without the sockets
+void benchJson(Runner& runner) {
+    std::string transcript = json{
+        {"type", "Results"},
+        {"is_final", true},
+        {"speech_final", true},
+        {"channel", {{"alternatives", json::array({{{"transcript", makeSentences(2)}, {"confidence", 0.98}}})}}}}
+                                 .dump();
+    runner.run("json/deepgram_transcript", transcript.size(), [&] {
+        auto parsed = json::parse(transcript, nullptr, false);
+        const auto& alternatives = parsed["channel"]["alternatives"];
+        benchSink = benchSink + alternatives[0].value("transcript", "").size() + parsed.value("is_final", false);
+    });
+
+    std::mt19937 rng(7);
+    std::string audioMessage = json{{"audio", makeBase64(16000, rng)}, {"isFinal", nullptr}}.dump();
+    std::vector<uint8_t> accumulated;
+    runner.run("json/elevenlabs_audio", audioMessage.size(), [&] {
+        auto jsonMsg = json::parse(audioMessage);
+        accumulated.clear();
+        Base64Decoder::decodeAppend(jsonMsg["audio"].get_ref<const std::string&>(), accumulated);
+        benchSink = benchSink + accumulated.size();
+    });
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time-ms") {
+            options.minTime = std::chrono::milliseconds(std::atoi(argv[++i]));
+        } else if (arg == "--output") {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: voicekit_bench [--filter <substring>] [--min-time-ms <ms>] [--output <file>]\n";
+        return EXIT_FAILURE;
+    }
+    spdlog::set_level(spdlog::level::warn); // per-session info logs would dominate the timings
+    useTemporaryCacheDir();
+
+    Runner runner(options);
+    benchSplitText(runner);
+    benchGenerateKey(runner);
+    benchCacheContention(runner);
+    benchBase64(runner);
+    benchPlayout(runner);
+    benchSTTQueue(runner);
+    benchJson(runner);
+
+    std::string report = runner.report().dump(2);
+    if (options.output.empty()) {
+        std::cout << report << std::endl;
+        return EXIT_SUCCESS;
+    }
+    std::ofstream file(options.output, std::ios::trunc);
+    if (!(file << report << '\n')) {
+        std::cerr << "Failed to write " << options.output << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
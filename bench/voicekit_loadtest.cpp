@@ -0,0 +1,414 @@
+#include "BenchCacheDir.h"
+#include "MockVendorServers.h"
+#include "STTFactory.h"
+#include "TTSCache.h"
+#include "TTSFactory.h"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Concurrent-session load test. Starts the mock vendor servers in a child process (so their
+// threads and memory stay out of the numbers) and points the modules at them through the
+// VendorEndpoints environment variables. For each session count it runs that many call
+// sessions side by side: a media loop streams 20 ms frames of synthetic caller audio into every
+// session's STT, and each final transcript triggers a TTS reply, like a voice bot turn.
+//
+//   voicekit_loadtest [--sessions 1,10,50,100] [--duration-s 20] [--stt Deepgram|none]
+//                     [--tts Deepgram|Elevenlabs|none] [--latency-ms 150] [--chunk-ms 100]
+//                     [--chunk-interval-ms 25] [--utterance-ms 2000] [--port 18080]
+//                     [--external] [--serve] [--output <file>]
+//
+// --external skips the mock servers and uses whatever the environment points at; --serve runs
+// only the mock servers, for driving them from other hosts. Prints one JSON document with,
+// per step: transcript and reply throughput, latency percentiles, process threads, peak RSS
+// and CPU, absolute and per session.
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int kSampleRate = 8000;
+constexpr auto kFrame = std::chrono::milliseconds(20);
+
+struct Options {
+    std::vector<int> sessions{1, 10, 50};
+    std::chrono::seconds duration{20};
+    std::string sttProvider = "Deepgram";
+    std::string ttsProvider = "Deepgram";
+    bool external = false;
+    bool serveOnly = false;
+    std::string output;
+    MockVendorServers::Options servers;
+};
+
+double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+json percentiles(std::vector<double> samples) {
+    if (samples.empty()) return {{"count", 0}};
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) { return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))]; };
+    return {{"count", samples.size()}, {"p50", at(0.50)}, {"p95", at(0.95)}, {"p99", at(0.99)}, {"max", samples.back()}};
+}
+
+struct ProcessSample {
+    int threads = 0;
+    long rssKb = 0;
+};
+
+ProcessSample sampleProcess() {
+    ProcessSample sample;
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("Threads:", 0) == 0) sample.threads = std::atoi(line.c_str() + 8);
+        if (line.rfind("VmRSS:", 0) == 0) sample.rssKb = std::atol(line.c_str() + 6);
+    }
+    return sample;
+}
+
+double cpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Everything the sessions of one step report, from module threads
+struct StepStats {
+    std::mutex mutex;
+    std::vector<double> transcriptLatencyMs;  // last frame of the utterance sent until its final transcript
+    std::vector<double> firstAudioMs;         // Speak() until the first chunk reached the callback
+    std::vector<double> replyMs;              // Speak() until the last chunk was played
+    std::atomic<uint64_t> transcripts{0};
+    std::atomic<uint64_t> replies{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> audioBytes{0};
+
+    std::mutex framesMutex;
+    std::vector<Clock::time_point> frameSentAt;  // by frame sequence number, shared by all sessions
+};
+
+struct Session {
+    int index = 0;
+    std::shared_ptr<I_STTModule> stt;
+    std::shared_ptr<I_TTSModule> tts;
+    std::atomic<int> turns{0};
+};
+
+void onTranscript(Session& session, StepStats& stats, const std::string& text) {
+    auto now = Clock::now();
+    ++stats.transcripts;
+    if (text.rfind("frame ", 0) == 0) {
+        size_t frame = std::strtoul(text.c_str() + 6, nullptr, 10);
+        std::lock_guard<std::mutex> lock(stats.framesMutex);
+        if (frame < stats.frameSentAt.size()) {
+            double ms = millisecondsBetween(stats.frameSentAt[frame], now);
+            std::lock_guard<std::mutex> statsLock(stats.mutex);
+            stats.transcriptLatencyMs.push_back(ms);
+        }
+    }
+    if (!session.tts) return;
+
+    // Unique text per turn, so every reply is a cache miss that reaches the vendor
+    int turn = ++session.turns;
+    SpeakHandle handle = session.tts->Speak("Session " + std::to_string(session.index) + " turn " +
+                                            std::to_string(turn) + ", sure, let me check that for you.");
+    ++stats.replies;
+    handle.firstAudio.then([&stats, now](bool played) {
+        if (!played) return;
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        stats.firstAudioMs.push_back(millisecondsBetween(now, Clock::now()));
+    });
+    handle.done.then([&stats, now](SpeakOutcome outcome) {
+        if (outcome == SpeakOutcome::Failed) ++stats.failed;
+        if (outcome != SpeakOutcome::Completed) return;
+        ++stats.completed;
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        stats.replyMs.push_back(millisecondsBetween(now, Clock::now()));
+    });
+}
+
+json runStep(const Options& options, int sessionCount) {
+    StepStats stats;
+    ProcessSample baseline = sampleProcess();
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (int i = 0; i < sessionCount; ++i) {
+        auto session = std::make_unique<Session>();
+        session->index = i;
+        std::string sid = "load-" + std::to_string(sessionCount) + "-" + std::to_string(i);
+
+        if (options.ttsProvider != "none") {
+            std::string voice = options.ttsProvider == "Deepgram" ? "aura-asteria-en" : "Mock";
+            session->tts = TTSFactory::CreateTTSModule(
+                options.ttsProvider, sid,
+                [&stats](const std::vector<uint8_t>& chunk) { stats.audioBytes += chunk.size(); }, voice);
+            session->tts->Initialise("mock-key", "");
+        }
+        if (options.sttProvider != "none") {
+            Session* raw = session.get();
+            session->stt = STTFactory::CreateSTTModule(
+                options.sttProvider, sid, [raw, &stats](std::string& text) { onTranscript(*raw, stats, text); },
+                "en-US");
+            STTConfig config;
+            config.sampleRate = kSampleRate;
+            session->stt->Configure(config);
+            session->stt->InitialiseSTTModule("mock-key", "");
+            session->stt->StartRecognition();
+        }
+        sessions.push_back(std::move(session));
+    }
+
+    // One media loop for all sessions, as a media server would run it
+    std::atomic<bool> stopMedia{false};
+    std::thread media([&] {
+        pthread_setname_np(pthread_self(), "LoadMedia");
+        std::vector<uint8_t> frame(kSampleRate * kFrame.count() / 1000 * 2);
+        for (size_t i = 4; i + 1 < frame.size(); i += 2) frame[i + 1] = (i / 2) % 16 < 8 ? 0x02 : 0xFE;
+        auto next = Clock::now();
+        for (uint32_t sequence = 0; !stopMedia; ++sequence) {
+            {
+                std::lock_guard<std::mutex> lock(stats.framesMutex);
+                stats.frameSentAt.push_back(Clock::now());
+            }
+            std::memcpy(frame.data(), &sequence, sizeof(sequence));
+            for (auto& session : sessions) {
+                if (session->stt) session->stt->StreamAudioData(frame);
+            }
+            next += kFrame;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    auto start = Clock::now();
+    double cpuStart = cpuSeconds();
+    ProcessSample peak = sampleProcess();
+    while (Clock::now() - start < options.duration) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        ProcessSample sample = sampleProcess();
+        peak.threads = std::max(peak.threads, sample.threads);
+        peak.rssKb = std::max(peak.rssKb, sample.rssKb);
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = cpuSeconds() - cpuStart;
+
+    stopMedia = true;
+    media.join();
+    for (auto& session : sessions) {
+        if (session->stt) session->stt->StopRecognition();
+        if (session->tts) session->tts->StopSpeak();
+    }
+    for (auto& session : sessions) {
+        session->stt.reset();
+        session->tts.reset();
+    }
+
+    double perSession = 1.0 / sessionCount;
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    double audioSeconds = stats.audioBytes / 2.0 / kSampleRate;
+    return {{"sessions", sessionCount},
+            {"wall_s", wallSeconds},
+            {"stt",
+             {{"transcripts", stats.transcripts.load()},
+              {"transcripts_per_s", stats.transcripts / wallSeconds},
+              {"latency_ms", percentiles(stats.transcriptLatencyMs)}}},
+            {"tts",
+             {{"replies", stats.replies.load()},
+              {"completed", stats.completed.load()},
+              {"failed", stats.failed.load()},
+              {"first_audio_ms", percentiles(stats.firstAudioMs)},
+              {"reply_ms", percentiles(stats.replyMs)},
+              {"audio_s_played", audioSeconds}}},
+            {"process",
+             {{"threads", peak.threads},
+              {"threads_per_session", (peak.threads - baseline.threads) * perSession},
+              {"rss_mb", peak.rssKb / 1024.0},
+              {"rss_mb_per_session", (peak.rssKb - baseline.rssKb) / 1024.0 * perSession},
+              {"cpu_percent", 100.0 * cpu / wallSeconds},
+              {"cpu_percent_per_session", 100.0 * cpu / wallSeconds * perSession}}}};
+}
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    for (std::string item; std::getline(stream, item, ',');) {
+        if (std::atoi(item.c_str()) > 0) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--external") {
+            options.external = true;
+            continue;
+        }
+        if (arg == "--serve") {
+            options.serveOnly = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sessions") options.sessions = parseList(value);
+        else if (arg == "--duration-s") options.duration = std::chrono::seconds(std::atoi(value.c_str()));
+        else if (arg == "--stt") options.sttProvider = value;
+        else if (arg == "--tts") options.ttsProvider = value;
+        else if (arg == "--latency-ms") options.servers.latency = std::chrono::milliseconds(std::atoi(value.c_str()));
+        else if (arg == "--chunk-ms") options.servers.chunk = std::chrono::milliseconds(std::atoi(value.c_str()));
+        else if (arg == "--chunk-interval-ms") options.servers.chunkInterval = std::chrono::milliseconds(std::atoi(value.c_str()));
+        else if (arg == "--utterance-ms") options.servers.utterance = std::chrono::milliseconds(std::atoi(value.c_str()));
+        else if (arg == "--port") options.servers.port = std::atoi(value.c_str());
+        else if (arg == "--output") options.output = value;
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.sessions.empty() || options.duration.count() <= 0) {
+        std::cerr << "Need at least one session count and a positive duration\n";
+        return false;
+    }
+    if (options.sttProvider == "Microsoft" || options.ttsProvider == "Microsoft") {
+        std::cerr << "Microsoft sessions use the Speech SDK protocol, which the mock servers do not speak\n";
+        return false;
+    }
+    return true;
+}
+
+// Runs the mock servers until SIGTERM/SIGINT; writes one byte to `readyFd` once listening
+int serveMockServers(const MockVendorServers::Options& options, int readyFd) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);  // before the server threads inherit the mask
+
+    MockVendorServers servers(options);
+    try {
+        servers.Start();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Mock vendor servers on " << servers.WebSocketUrl() << " and " << servers.HttpUrl() << "\n";
+    if (readyFd >= 0) {
+        char ready = 1;
+        if (write(readyFd, &ready, 1) != 1) return EXIT_FAILURE;
+        close(readyFd);
+    }
+    int signal = 0;
+    sigwait(&signals, &signal);
+    servers.Stop();
+    return EXIT_SUCCESS;
+}
+
+// Forks the mock servers and waits until they listen; returns the child pid, or -1
+pid_t startMockServers(const MockVendorServers::Options& options) {
+    int ready[2];
+    if (pipe(ready) != 0) return -1;
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        _exit(serveMockServers(options, ready[1]));
+    }
+    close(ready[1]);
+    char byte = 0;
+    bool listening = child > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+    if (!listening) {
+        if (child > 0) waitpid(child, nullptr, 0);
+        return -1;
+    }
+
+    std::string webSocketUrl = "ws://" + options.host + ":" + std::to_string(options.port);
+    setenv("VOICEKIT_DEEPGRAM_URL", webSocketUrl.c_str(), 1);
+    setenv("VOICEKIT_ELEVENLABS_URL", webSocketUrl.c_str(), 1);
+    setenv("VOICEKIT_ELEVENLABS_API_URL", ("http://" + options.host + ":" + std::to_string(options.port + 1)).c_str(), 1);
+    return child;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return EXIT_FAILURE;
+    if (options.serveOnly) return serveMockServers(options.servers, -1);
+
+    pid_t servers = -1;
+    if (!options.external) {
+        servers = startMockServers(options.servers);
+        if (servers < 0) {
+            std::cerr << "Failed to start the mock vendor servers\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Keep per-session logging and the disk cache from dominating the measurement. Each run starts
+    // from an empty cache; set up after the fork, so only this process removes it.
+    spdlog::set_level(spdlog::level::warn);
+    useTemporaryCacheDir();
+    TTSCache::getInstance().setDiskBudget(64ull << 20);
+
+    json steps = json::array();
+    for (int sessionCount : options.sessions) {
+        json step = runStep(options, sessionCount);
+        std::cerr << sessionCount << " sessions: " << step["stt"]["transcripts_per_s"] << " transcripts/s, "
+                  << "transcript p95 " << step["stt"]["latency_ms"].value("p95", 0.0) << " ms, "
+                  << "first audio p95 " << step["tts"]["first_audio_ms"].value("p95", 0.0) << " ms, "
+                  << step["process"]["threads"] << " threads, " << step["process"]["cpu_percent"] << "% CPU\n";
+        steps.push_back(step);
+    }
+
+    if (servers > 0) {
+        kill(servers, SIGTERM);
+        waitpid(servers, nullptr, 0);
+    }
+
+    json report = {{"schema", 1},
+                   {"timestamp", std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::system_clock::now().time_since_epoch()).count()},
+                   {"hardware_threads", std::thread::hardware_concurrency()},
+                   {"stt", options.sttProvider},
+                   {"tts", options.ttsProvider},
+                   {"duration_s", options.duration.count()},
+                   {"mock_latency_ms", options.external ? -1 : options.servers.latency.count()},
+                   {"steps", steps}};
+    std::string text = report.dump(2);
+    if (options.output.empty()) {
+        std::cout << text << std::endl;
+        return EXIT_SUCCESS;
+    }
+    std::ofstream file(options.output, std::ios::trunc);
+    if (!(file << text << '\n')) {
+        std::cerr << "Failed to write " << options.output << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Streaming polyphase resampler for 16-bit little-endian mono PCM.
+// Converts between any two rates whose ratio reduces to L/M <= 1000 (e.g. 16k/22.05k/24k/48k -> 8k/16k).
+// Filter state carries across process() calls, so vendor chunks can be fed as they arrive.
+class AudioResampler {
+public:
+    AudioResampler(int inputRate, int outputRate);
+
+    // Resamples a block of PCM bytes. An odd trailing byte is held until the next call.
+    std::vector<uint8_t> process(const uint8_t* data, size_t size);
+    void process(const int16_t* samples, size_t count, std::vector<int16_t>& out);
+
+    // Drains the filter delay line; call once after the last block of a stream.
+    std::vector<uint8_t> flush();
+
+    void reset();
+
+    int inputRate() const { return m_inputRate; }
+    int outputRate() const { return m_outputRate; }
+
+    // One-shot conversion of a complete buffer.
+    static std::vector<uint8_t> convert(const std::vector<uint8_t>& pcm, int inputRate, int outputRate);
+    static bool isSupported(int inputRate, int outputRate);
+
+    struct Filter;
+
+private:
+    void run(std::vector<int16_t>& out);
+
+    int m_inputRate;
+    int m_outputRate;
+    std::shared_ptr<const Filter> m_filter;
+    std::vector<float> m_buffer;   // delay line followed by unconsumed input
+    uint64_t m_position = 0;       // next output position in the upsampled domain, relative to m_buffer[0]
+    bool m_hasCarry = false;
+    uint8_t m_carry = 0;
+};
+
+#endif // AUDIORESAMPLER_H
@@ -0,0 +1,30 @@
+#ifndef AUDIOSPLICER_H
+#define AUDIOSPLICER_H
+
+#include "CachedAudio.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Joins complete 16-bit little-endian mono PCM clips into one buffer, for prompts assembled from
+// separately synthesised pieces. Vendor padding at each clip's edges is trimmed down to a short
+// pause, and neighbouring clips overlap by a linear crossfade so the joins do not click.
+class AudioSplicer {
+public:
+    struct Options {
+        int sampleRate = 8000;
+        int crossfadeMs = 10;
+        int pauseMs = 40;             // silence kept at each trimmed edge
+        int silenceThreshold = 256;   // |sample| at or below this counts as silence
+    };
+
+    static std::vector<uint8_t> splice(const std::vector<CachedAudio>& clips, const Options& options);
+
+    // Sample range [begin, end) left after trimming silence beyond `keep` samples at either edge.
+    // An all-silent clip yields begin == end.
+    static void trimSilence(const int16_t* samples, size_t count, int threshold, size_t keep,
+                            size_t& begin, size_t& end);
+};
+
+#endif // AUDIOSPLICER_H
@@ -0,0 +1,77 @@
+#ifndef AZURE_SPEECH_H
+#define AZURE_SPEECH_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <speechapi_cxx.h>
+
+using namespace Microsoft::CognitiveServices::Speech;
+
+/*
+    Azure Speech objects shared across sessions.
+
+    SpeechConfigs are built once per credential and settings (voice and output
+    format for synthesis, language for recognition) and never changed after
+    they are handed out, so concurrent FromConfig calls can share them.
+
+    Synthesizers are pooled per config. Each one has its service connection
+    opened ahead of use (Connection::Open), so the first utterance of a call
+    does not pay for the connection setup. MicrosoftTTS takes one in
+    Initialise and hands it back when destroyed:
+
+        AzureSpeech::getInstance().prewarmSynthesizers(key, region, "en-US-JennyNeural",
+                                                       SpeechSynthesisOutputFormat::Raw8Khz16BitMonoPcm, 8);
+*/
+class AzureSpeech {
+public:
+    static AzureSpeech& getInstance();
+
+    std::shared_ptr<SpeechConfig> synthesisConfig(const std::string& apiKey, const std::string& region,
+                                                  const std::string& voiceName, SpeechSynthesisOutputFormat format);
+    // Carries the recognition language and the module's silence timeouts
+    std::shared_ptr<SpeechConfig> recognitionConfig(const std::string& apiKey, const std::string& region,
+                                                    const std::string& language);
+
+    // An idle synthesizer for the settings, or a new one; its connection is (re)opened either way
+    std::shared_ptr<SpeechSynthesizer> acquireSynthesizer(const std::string& apiKey, const std::string& region,
+                                                          const std::string& voiceName, SpeechSynthesisOutputFormat format);
+    // Disconnects the caller's event handlers and keeps the synthesizer for the next session.
+    // Pass reusable = false after a synthesis error; the synthesizer is then destroyed.
+    void releaseSynthesizer(const std::shared_ptr<SpeechSynthesizer>& synthesizer, bool reusable = true);
+    // Creates synthesizers on the calling thread until `count` are idle for the settings
+    void prewarmSynthesizers(const std::string& apiKey, const std::string& region, const std::string& voiceName,
+                             SpeechSynthesisOutputFormat format, size_t count);
+
+    // Starts connecting the recognizer's service connection without waiting for it
+    static void openConnection(const std::shared_ptr<SpeechRecognizer>& recognizer);
+
+    void setMaxIdleSynthesizers(size_t count);  // per settings; default 16
+    size_t idleSynthesizers();
+
+private:
+    AzureSpeech() = default;
+    AzureSpeech(const AzureSpeech&) = delete;
+    AzureSpeech& operator=(const AzureSpeech&) = delete;
+
+    struct PooledSynthesizer {
+        std::shared_ptr<SpeechSynthesizer> synthesizer;
+        std::shared_ptr<Connection> connection;
+        std::string key;  // synthesisKey of its settings
+    };
+
+    static std::string synthesisKey(const std::string& apiKey, const std::string& region,
+                                    const std::string& voiceName, SpeechSynthesisOutputFormat format);
+    PooledSynthesizer createSynthesizer(const std::string& apiKey, const std::string& region,
+                                        const std::string& voiceName, SpeechSynthesisOutputFormat format);
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<SpeechConfig>> configs;
+    std::map<std::string, std::deque<PooledSynthesizer>> idle;           // by synthesisKey
+    std::map<SpeechSynthesizer*, PooledSynthesizer> leased;
+    size_t maxIdle = 16;
+};
+
+#endif // AZURE_SPEECH_H
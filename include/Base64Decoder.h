@@ -0,0 +1,32 @@
+#ifndef BASE64DECODER_H
+#define BASE64DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Table-driven base64 decoder with SSE4.1/AVX2 kernels selected at runtime.
+// Decodes straight into caller-owned memory; used on the ElevenLabs audio path
+// where every chunk arrives base64 encoded.
+class Base64Decoder {
+public:
+    enum class Kernel { Scalar, SSE41, AVX2 };
+
+    // Upper bound of decoded bytes for `length` base64 characters.
+    static size_t maxDecodedSize(size_t length);
+
+    // Decodes `length` characters from `input` into `output`, which must hold at least
+    // maxDecodedSize(length) bytes. Returns the number of bytes written or -1 on invalid input.
+    static ptrdiff_t decode(const char* input, size_t length, uint8_t* output);
+    static ptrdiff_t decode(const char* input, size_t length, uint8_t* output, Kernel kernel);
+
+    // Appends the decoded bytes of `input` to `output`. Leaves `output` untouched on failure.
+    static bool decodeAppend(const std::string& input, std::vector<uint8_t>& output);
+
+    static Kernel bestKernel();
+    static bool isSupported(Kernel kernel);
+    static const char* kernelName(Kernel kernel);
+};
+
+#endif // BASE64DECODER_H
@@ -0,0 +1,67 @@
+#ifndef BULK_TRANSCRIBER_H
+#define BULK_TRANSCRIBER_H
+
+#include "EnergyVAD.h"
+#include "I_STTModule.h"
+#include "STTModuleBase.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+    Faster-than-real-time transcription of recorded calls, for post-call analytics.
+
+    A recording is split at silences into pieces of about `chunkSeconds`; up to
+    `parallel` pieces are transcribed at once, each on its own STT module and
+    vendor connection using STTModuleBase::TranscribeAudio (audio streamed as
+    fast as the vendor socket accepts it). The pieces' transcripts are shifted
+    by their offset in the recording and joined in order, so throughput is
+    bounded by the vendor rather than by the length of the call.
+
+        BulkTranscriber::Options options;
+        options.provider = "Deepgram";
+        options.config.apiKey = key;
+        auto result = BulkTranscriber(options).TranscribeFile("call.wav");
+
+    A piece that fails is logged and listed in Result::errors; the rest of the
+    transcript is still returned.
+*/
+class BulkTranscriber {
+public:
+    struct Options {
+        std::string provider;                 // as registered with STTFactory
+        STTConfig config;                     // apiKey, region, language; sampleRate for raw input
+        size_t parallel = 4;                  // vendor connections at once
+        int chunkSeconds = 300;               // target piece length
+        int searchSeconds = 30;               // how far from the target a split may move to find silence
+        int minSilenceMs = 300;               // shortest pause that counts as a clean split
+        double silenceDb = -45.0;             // frames below this RMS level (dBFS) are silence
+        STTModuleBase::BulkOptions stream;
+    };
+
+    struct Result {
+        std::vector<TranscriptSegment> segments;  // offsets into the whole recording
+        std::string text;                         // segments joined with spaces
+        double audioMs = 0;
+        double elapsedMs = 0;
+        size_t pieces = 0;
+        std::vector<std::string> errors;          // one per failed piece
+    };
+
+    explicit BulkTranscriber(const Options& options);
+
+    // 16-bit mono PCM at options.config.sampleRate
+    Result Transcribe(const std::vector<uint8_t>& pcm);
+    // A 16-bit mono PCM WAV file (its sample rate is used), or raw PCM at options.config.sampleRate.
+    // Throws std::runtime_error if the file cannot be read or has another format.
+    Result TranscribeFile(const std::string& path);
+
+    // Byte offsets at which the pieces of `pcm` start, the first being 0
+    static std::vector<size_t> SplitPoints(const std::vector<uint8_t>& pcm, int sampleRate, const Options& options);
+
+private:
+    Options m_options;
+};
+
+#endif // BULK_TRANSCRIBER_H
@@ -0,0 +1,34 @@
+#ifndef CACHEDAUDIO_H
+#define CACHEDAUDIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Read-only view of cached PCM. Holds a reference to whatever backs the bytes
+// (a heap buffer in the memory tier, a file mapping in the disk tier), so the
+// data stays valid for as long as the view exists and hits are served without copying.
+class CachedAudio {
+public:
+    CachedAudio() = default;
+    CachedAudio(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+        : m_owner(std::move(owner)), m_data(data), m_size(size) {}
+    explicit CachedAudio(std::shared_ptr<const std::vector<uint8_t>> buffer)
+        : m_data(buffer ? buffer->data() : nullptr), m_size(buffer ? buffer->size() : 0) {
+        m_owner = std::move(buffer);
+    }
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(m_data, m_data + m_size); }
+
+private:
+    std::shared_ptr<const void> m_owner;
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // CACHEDAUDIO_H
@@ -0,0 +1,110 @@
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define VOICEKIT_HAS_COROUTINES 1
+#endif
+
+/*
+    One-shot completion shared between a module (which resolves it) and any
+    number of waiters. Copies share the same state. Waiters can block with
+    get()/waitFor(), chain with then() (runs on the thread that resolves, or
+    immediately if already resolved), or, when built as C++20, co_await it:
+    the coroutine resumes on the resolving thread, usually the module's
+    processing thread, so it should hand heavy work elsewhere.
+*/
+template <typename T>
+class Completion {
+public:
+    Completion() : m_state(std::make_shared<State>()) {}
+
+    // First call wins; returns false if already resolved
+    bool resolve(T value) const {
+        std::vector<std::function<void(const T&)>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            if (m_state->resolved) return false;
+            m_state->resolved = true;
+            m_state->promise.set_value(value);
+            callbacks.swap(m_state->callbacks);
+        }
+        for (auto& callback : callbacks) callback(value);
+        return true;
+    }
+
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->resolved;
+    }
+    // Blocks until resolved
+    T get() const { return m_state->future.get(); }
+    template <typename Rep, typename Period>
+    bool waitFor(std::chrono::duration<Rep, Period> timeout) const {
+        return m_state->future.wait_for(timeout) == std::future_status::ready;
+    }
+    std::shared_future<T> future() const { return m_state->future; }
+
+    void then(std::function<void(const T&)> callback) const {
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            if (!m_state->resolved) {
+                m_state->callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback(m_state->future.get());
+    }
+
+#ifdef VOICEKIT_HAS_COROUTINES
+    struct Awaiter {
+        std::shared_ptr<typename Completion::State> state;
+
+        bool await_ready() const {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return state->resolved;
+        }
+        bool await_suspend(std::coroutine_handle<> handle) const {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->resolved) return false;
+            state->callbacks.push_back([handle](const T&) { handle.resume(); });
+            return true;
+        }
+        T await_resume() const { return state->future.get(); }
+    };
+    Awaiter operator co_await() const { return Awaiter{m_state}; }
+#endif
+
+private:
+    struct State {
+        State() : future(promise.get_future().share()) {}
+        std::mutex mutex;
+        bool resolved = false;
+        std::promise<T> promise;
+        std::shared_future<T> future;
+        std::vector<std::function<void(const T&)>> callbacks;
+    };
+    std::shared_ptr<State> m_state;
+};
+
+enum class SpeakOutcome {
+    Completed,  // every segment played
+    Cancelled,  // StopSpeak() was called before or during playout
+    Failed      // no audio could be produced
+};
+
+// Returned by I_TTSModule::Speak. `firstAudio` resolves true when the first chunk reaches the
+// callback, or false if playout ends without audio; `done` resolves after the last chunk.
+struct SpeakHandle {
+    Completion<bool> firstAudio;
+    Completion<SpeakOutcome> done;
+};
+
+#endif // COMPLETION_H
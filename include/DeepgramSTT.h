@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <condition_variable>
 
 using json = nlohmann::json;
 
@@ -19,12 +20,25 @@ public:
     void ImplStartRecognition() override;
     void ImplStopRecognition() override;
     void ImplRecognize() override;
+    const char* VendorName() const override { return "deepgram"; }
+
+protected:
+    void ImplBeginBulk() override;
+    void ImplStreamBulk(const uint8_t* audioData, size_t size) override;
+    void ImplEndBulk() override;
+    void ImplAbortBulk() override;
 
 private:
+    // Opens the listen socket; bulk runs skip interim results and never reconnect
+    void connect(bool bulk);
+
     std::string apiKey;
     ix::WebSocket webSocket;
     std::mutex wsMutex;
+    std::condition_variable wsCV;  // signals isConnected and socketClosed changes
     bool isConnected = false;
+    bool socketClosed = false;
+    std::string socketError;
     void handleMessage(const std::string& message);
 };
 
@@ -15,9 +15,15 @@ public:
     bool Initialise(const std::string& apiKey, const std::string& voiceName) override;
     void ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) override;
     void CloseConnection();
+    const char* VendorName() const override { return "deepgram"; }
+
+protected:
+    void ImplCancelSynthesis() override;
 
 private:
     void StartWebSocket();
+    // Drops the socket and connects again; for a server that never confirmed a Clear
+    void Reconnect();
     void handleMessage(const std::string& message);
 
     std::string buildWebSocketURL() const;
@@ -48,6 +54,9 @@ private:
     std::atomic<bool> isFlushedReceived = {false};
     std::condition_variable flushedCv;
     std::mutex flushedMutex;
+    // Set when a Clear is sent, until the server's "Cleared": audio and "Flushed" received meanwhile
+    // belong to the cancelled request and are dropped. Guarded by flushedMutex.
+    bool m_clearing = false;
 
 
 };
@@ -0,0 +1,112 @@
+#ifndef DUPLEX_SESSION_H
+#define DUPLEX_SESSION_H
+
+#include "EnergyVAD.h"
+#include "I_STTModule.h"
+#include "I_TTSModule.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+    One call's STT and TTS modules, paired so the caller can interrupt a prompt.
+
+    Caller audio goes through StreamAudioData, which runs an EnergyVAD on each
+    frame before passing it to STT. When the detector reports a speech onset,
+    or the STT vendor reports SpeechStarted, while a Speak() made through the
+    session is still playing, the session calls StopSpeak on the TTS module.
+    Playout stops at its next 20 ms chunk, without waiting for a transcript.
+
+        DuplexSession session(stt, tts);
+        session.SetBargeInCallback([](DuplexSession::BargeInSource, double ms) { ... });
+        session.StartRecognition();
+        session.Speak("Thanks for calling. How can I help?");
+        // media thread:
+        session.StreamAudioData(frame);
+
+    StopSpeak runs on a short-lived task, so a vendor that waits on its service
+    to cancel (Azure) does not stall the media thread. The reaction time, from
+    detection until StopSpeak returns, is reported as Metric::BargeInReaction
+    and kept in GetStats(). It does not include the detector's onsetMs.
+
+    The destructor waits for an STT event the session is handling, so it must
+    not run from the session's own event or barge-in callback.
+*/
+class DuplexSession {
+public:
+    enum class BargeInSource { LocalVAD, VendorSpeechStart };
+
+    struct Options {
+        bool bargeIn = true;
+        bool vendorSpeechStart = true;  // also barge in on the STT vendor's SpeechStarted event
+        EnergyVAD::Options vad;         // vad.sampleRate must match the audio passed to StreamAudioData
+    };
+
+    struct Stats {
+        uint64_t bargeIns = 0;
+        uint64_t vadOnsets = 0;          // onsets heard, whether or not TTS was playing
+        uint64_t vendorOnsets = 0;
+        double lastReactionMs = 0;
+        double maxReactionMs = 0;
+    };
+
+    DuplexSession(std::shared_ptr<I_STTModule> stt, std::shared_ptr<I_TTSModule> tts);
+    DuplexSession(std::shared_ptr<I_STTModule> stt, std::shared_ptr<I_TTSModule> tts, const Options& options);
+    ~DuplexSession();
+
+    DuplexSession(const DuplexSession&) = delete;
+    DuplexSession& operator=(const DuplexSession&) = delete;
+
+    // Caller audio, one thread at a time
+    void StreamAudioData(std::vector<uint8_t> audioData);
+    void StartRecognition();
+    void StopRecognition();
+
+    // Only speech started here can be barged in on
+    SpeakHandle Speak(const std::string& text);
+    void StopSpeak();
+    bool IsSpeaking() const { return m_speaking->load() > 0; }
+
+    void SetBargeInCallback(std::function<void(BargeInSource source, double reactionMs)> callback);
+    // STT events, passed on after the session has looked at them
+    void SetEventCallback(std::function<void(const STTEvent&)> callback);
+
+    Stats GetStats();
+    I_STTModule& STT() { return *m_stt; }
+    I_TTSModule& TTS() { return *m_tts; }
+
+private:
+    void OnSTTEvent(const STTEvent& event);
+    void BargeIn(BargeInSource source);
+
+    std::shared_ptr<I_STTModule> m_stt;
+    std::shared_ptr<I_TTSModule> m_tts;
+    Options m_options;
+    MetricLabels m_labels;
+
+    EnergyVAD m_vad;  // used by the StreamAudioData thread only
+    // Speak() calls not yet done; shared with their completion callbacks, which may outlive the session
+    std::shared_ptr<std::atomic<int>> m_speaking;
+    // Shared with the STT event callback, which a vendor thread may still be running after
+    // SetEventCallback(nullptr); the destructor clears `session` under `mutex`, waiting that call out
+    struct EventTarget {
+        std::mutex mutex;
+        DuplexSession* session = nullptr;
+    };
+    std::shared_ptr<EventTarget> m_eventTarget;
+
+    std::mutex mutex;
+    std::future<void> m_bargeInTask;  // the StopSpeak in progress
+    std::function<void(BargeInSource, double)> m_bargeInCallback;
+    std::function<void(const STTEvent&)> m_eventCallback;
+    Stats m_stats;
+};
+
+#endif // DUPLEX_SESSION_H
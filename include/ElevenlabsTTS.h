@@ -2,7 +2,7 @@
 #define ELEVENLABSTTS_H
 
 #include "TTSModuleBase.h"
-#include "base64.hpp"
+#include "Base64Decoder.h"
 
 #include <ixwebsocket/IXWebSocket.h>
 #include <nlohmann/json.hpp>
@@ -24,9 +24,15 @@ public:
     bool Initialise(const std::string& apiKey, const std::string& voiceId) override;
     void ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) override;
     void CloseConnection();
+    const char* VendorName() const override { return "elevenlabs"; }
+
+protected:
+    void ImplCancelSynthesis() override;
 
 private:
     void startWebSocket();
+    // Waits for an open connection no request has used yet and claims it; false on timeout
+    bool claimFreshConnection();
     void handleMessage(const std::string& message);
     std::string buildWebSocketURL() const;
     void sendInitialSettings();
@@ -45,6 +51,11 @@ private:
     std::condition_variable m_finalCv;
 
     std::atomic<bool> m_isConnected{false};
+    // Each request gets a connection of its own, closed after isFinal or a cancel. Opens are
+    // numbered on the socket thread, so a message belongs to the connection counted when it
+    // arrives; messages of any connection but the current request's are dropped. Guarded by wsMutex.
+    uint64_t m_openedConnection = 0;
+    uint64_t m_requestConnection = 0;
     std::atomic<bool> m_isFinalReceived{false};
 
     std::string m_apiKey;
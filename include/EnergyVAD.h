@@ -0,0 +1,42 @@
+#ifndef ENERGYVAD_H
+#define ENERGYVAD_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Speech onset detector for 16-bit little-endian mono PCM, cheap enough to run on every inbound
+// frame. A frame is voiced when its RMS level clears both an absolute threshold and a margin over
+// the background level, which is tracked while the caller is silent. An onset is reported once
+// `onsetMs` of voiced audio has accumulated; unvoiced frames wear the count down again, so short
+// clicks do not add up.
+class EnergyVAD {
+public:
+    struct Options {
+        int sampleRate = 8000;
+        double thresholdDb = -40.0;   // dBFS a voiced frame must reach
+        double marginDb = 12.0;       // ... and how far above the noise floor
+        int onsetMs = 60;             // voiced audio before an onset is reported
+        int releaseMs = 400;          // unvoiced audio that ends the speech
+    };
+
+    EnergyVAD();
+    explicit EnergyVAD(const Options& options);
+
+    // Returns true for the frame that completes a speech onset; false while speech continues
+    bool process(const uint8_t* pcm, size_t size);
+    bool inSpeech() const { return m_inSpeech; }
+    double noiseFloorDb() const { return m_noiseFloorDb; }
+    void reset();
+
+    // RMS level of the samples in dBFS; -100 for silence
+    static double levelDb(const int16_t* samples, size_t count);
+
+private:
+    Options m_options;
+    double m_noiseFloorDb;
+    double m_voicedMs = 0;
+    double m_unvoicedMs = 0;
+    bool m_inSpeech = false;
+};
+
+#endif // ENERGYVAD_H
@@ -0,0 +1,36 @@
+#ifndef HEDGEDTTS_H
+#define HEDGEDTTS_H
+
+#include "TTSModuleBase.h"
+#include <chrono>
+#include <memory>
+
+// Composite TTS that bounds time-to-first-audio. Each segment goes to the primary vendor;
+// if it has not produced audio within the deadline, the secondary is started for the same
+// segment. Whichever delivers audio first is played and the other is cancelled. A segment
+// still unfinished after segmentDeadline is cancelled on both vendors and fails the speech.
+class HedgedTTS : public TTSModuleBase {
+public:
+    HedgedTTS(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb,
+              std::shared_ptr<TTSModuleBase> primary, std::shared_ptr<TTSModuleBase> secondary,
+              std::chrono::milliseconds firstAudioDeadline,
+              std::chrono::milliseconds segmentDeadline = std::chrono::seconds(30));
+
+    // Primary and secondary are initialised by the caller with their own credentials
+    bool Initialise(const std::string& apiKey, const std::string& region) override;
+    void ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) override;
+    void SetOutputSampleRate(int sampleRate) override;
+    // Keys and stats follow the primary, so hedged and plain sessions share cached audio
+    const char* VendorName() const override { return m_primary->VendorName(); }
+
+protected:
+    void ImplCancelSynthesis() override;
+
+private:
+    std::shared_ptr<TTSModuleBase> m_primary;
+    std::shared_ptr<TTSModuleBase> m_secondary;
+    std::chrono::milliseconds m_firstAudioDeadline;
+    std::chrono::milliseconds m_segmentDeadline;
+};
+
+#endif // HEDGEDTTS_H
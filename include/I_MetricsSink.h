@@ -0,0 +1,51 @@
+#ifndef I_METRICS_SINK_H
+#define I_METRICS_SINK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Latencies and counters reported by the STT and TTS modules
+enum class Metric {
+    TTSQueueWait,           // Speak() until the processing thread picks the text up
+    TTSTimeToFirstAudio,    // vendor request until its first audio chunk
+    TTSSynthesisTime,       // vendor request until the complete audio, as measured by the vendor module
+    TTSCachedPlayoutStart,  // segment start until its first chunk is played, for cache hits
+    TTSPlayoutUnderrun,     // counter: chunks delivered more than a frame late mid-speech
+    STTQueueWait,           // StreamAudioData() until the audio is handed to the vendor
+    STTFinalResult,         // counter: final transcripts
+    BargeInReaction,        // DuplexSession: caller speech detected until TTS playout was stopped
+};
+
+// Prometheus-style name without unit suffix, e.g. "voicekit_tts_time_to_first_audio"
+const char* MetricName(Metric metric);
+bool IsCounterMetric(Metric metric);
+
+struct MetricLabels {
+    std::string vendor;   // "microsoft", "deepgram", ...
+    std::string voice;    // TTS voice, or STT language
+    std::string session;  // stream sid
+};
+
+// Implemented by hosts (or PrometheusExporter) to receive telemetry; calls come from module
+// threads, often on the audio path, so implementations must be thread-safe and cheap.
+class I_MetricsSink {
+public:
+    virtual ~I_MetricsSink() = default;
+
+    virtual void RecordLatency(Metric metric, const MetricLabels& labels, double milliseconds) = 0;
+    virtual void IncrementCounter(Metric metric, const MetricLabels& labels, uint64_t delta) = 0;
+
+    // One label set bound to this sink. Modules resolve their labels once (see MetricsSeries)
+    // and report through it, so the audio path neither builds labels nor looks series up.
+    class Series {
+    public:
+        virtual ~Series() = default;
+        virtual void RecordLatency(Metric metric, double milliseconds) = 0;
+        virtual void IncrementCounter(Metric metric, uint64_t delta) = 0;
+    };
+    // The default forwards to the calls above with a copy of `labels`
+    virtual std::shared_ptr<Series> Resolve(const MetricLabels& labels);
+};
+
+#endif // I_METRICS_SINK_H
@@ -6,28 +6,50 @@
 #include <functional>
 #include <cstdint>
 
+#include "Completion.h"
+
 struct STTConfig {
-    std::string vendor;         // E.g., "Azure", "Google", "AWS"
-    std::string apiKey;         // Vendor key
-    std::string region;         // Microsoft region. 
-    std::string language;       // default: en-US
-    std::string model;          // default: 
-    int sampleRate;             // default: 8000 ; 8000 16000 48000
-    int channel;                // default: mono ; mono sterio. 
-    int initialSilenceInMs;     // default: 5000ms
-    int segmentSilenceInMs;     // default: 2000ms
-    int finalSilenceInMs;       // default: 1000ms
-    std::string boostPhrases;   // comma seperated boost phrases.
-    bool profanityFilter;       // Optional vendor-specific settings
+    std::string vendor;             // E.g., "Azure", "Google", "AWS"
+    std::string apiKey;             // Vendor key
+    std::string region;             // Microsoft region. 
+    std::string language = "en-US"; // default: en-US
+    std::string model;              // default: 
+    int sampleRate = 8000;          // default: 8000 ; 8000 16000 48000
+    int channel = 1;                // default: mono ; mono sterio. 
+    int initialSilenceInMs = 5000;  // default: 5000ms
+    int segmentSilenceInMs = 2000;  // default: 2000ms
+    int finalSilenceInMs = 1000;    // default: 1000ms
+    std::string boostPhrases;       // comma seperated boost phrases.
+    bool profanityFilter = false;   // Optional vendor-specific settings
+};
+
+enum class STTEventType {
+    RecognitionStarted,  // the vendor is listening; audio streamed before this is buffered
+    RecognitionStopped,
+    SpeechStarted,       // the vendor's voice activity detector heard the caller start speaking
+    Error                // start, stop or the recognition session failed; see detail
+};
+
+struct STTEvent {
+    STTEventType type;
+    std::string detail;
 };
 
 class I_STTModule {
 public:
     virtual ~I_STTModule() = default;
+    // Optional; sampleRate is the rate of audio passed to StreamAudioData. Call before InitialiseSTTModule.
+    virtual void Configure(const STTConfig& config) = 0;
     virtual void InitialiseSTTModule(const std::string& subscriptionKey, const std::string& region) = 0;
     virtual void StartRecognition() = 0;
     virtual void StopRecognition() = 0;
     virtual void StreamAudioData(std::vector<uint8_t> audioData) = 0;
+    // Resolves with the next final transcript recognised after the call (it is also passed to the
+    // callback as before), or with an empty string if recognition stops first.
+    virtual Completion<std::string> NextUtterance() = 0;
+    // Optional; reports when StartRecognition/StopRecognition take effect at the vendor, which
+    // may be well after they return. Called on the module's or the vendor SDK's threads.
+    virtual void SetEventCallback(std::function<void(const STTEvent&)> callback) = 0;
 };
 
 #endif // I_STT_MODULE_H
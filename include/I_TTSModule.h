@@ -5,6 +5,8 @@
 #include <vector>
 #include <functional>
 
+#include "Completion.h"
+
 
 class I_TTSModule {
 public:
@@ -13,11 +15,15 @@ public:
     // Initialize TTS module with necessary parameters
     virtual bool Initialise(const std::string& apiKey, const std::string& region) = 0;
 
-    // Convert text to speech and play audio at intervals
-    virtual void Speak(const std::string& text) = 0;
+    // Convert text to speech and play audio at intervals; the handle tracks first and last audio
+    virtual SpeakHandle Speak(const std::string& text) = 0;
 
-    // Stop speak in case of interruption
+    // Stop speak in case of interruption: drops queued text and cuts off the current playout.
+    // Their handles resolve SpeakOutcome::Cancelled.
     virtual void StopSpeak() = 0;
+
+    // Sample rate of the PCM delivered to the callback (default 8000). Call before Initialise.
+    virtual void SetOutputSampleRate(int sampleRate) = 0;
 };
 
 #endif // I_TTSMODULE_H
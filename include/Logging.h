@@ -0,0 +1,94 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Per-frame sites (every audio chunk, every interim transcript) compile to nothing unless the
+// build sets VOICEKIT_FRAME_LOG_LEVEL to an SPDLOG_LEVEL_* value; they then log at that level.
+#ifndef VOICEKIT_FRAME_LOG_LEVEL
+#define VOICEKIT_FRAME_LOG_LEVEL SPDLOG_LEVEL_OFF
+#endif
+
+#if VOICEKIT_FRAME_LOG_LEVEL < SPDLOG_LEVEL_OFF
+#define VOICEKIT_LOG_FRAME(...)                                                                         \
+    SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(),                                                   \
+                       static_cast<spdlog::level::level_enum>(VOICEKIT_FRAME_LOG_LEVEL), __VA_ARGS__)
+#else
+#define VOICEKIT_LOG_FRAME(...) (void)0
+#endif
+
+// Per-session sites that repeat with traffic (segments, final transcripts) pass through the
+// session's LogLimiter. Messages below the logger level are skipped before the limiter, and
+// the ones it drops are counted, never formatted.
+#define VOICEKIT_LOG_SESSION(limiter, level, ...)                                                       \
+    do {                                                                                                \
+        if (spdlog::default_logger_raw()->should_log(level) && (limiter).allow()) {                     \
+            SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), level, __VA_ARGS__);                       \
+        }                                                                                               \
+    } while (0)
+
+/*
+    Process-wide logging setup. By default the modules log through spdlog's
+    synchronous default logger; enableAsync() swaps in an async logger so
+    formatting and I/O leave the audio and WebSocket threads. The queue drops
+    the oldest message when full rather than stalling a call.
+
+    Each session rate-limits its own repeated messages with a token bucket
+    (setSessionLimits). Once a session's bucket is empty, only every
+    `sampleEvery`-th message gets through, so a flood stays visible without
+    costing more. Everything dropped is counted in suppressedMessages().
+*/
+class Logging {
+public:
+    struct AsyncOptions {
+        size_t queueSize = 8192;                  // messages
+        bool blockWhenFull = false;               // true: wait for space instead of dropping the oldest
+        std::chrono::seconds flushInterval{1};
+        std::vector<spdlog::sink_ptr> sinks;      // empty: colour stderr
+    };
+
+    struct SessionLimits {
+        double perSecond = 20.0;   // sustained messages per session
+        uint32_t burst = 50;       // messages a quiet session may log at once
+        uint32_t sampleEvery = 100; // when over the limit, let 1 in N through; 0 drops them all
+    };
+
+    // Replaces the default logger with an async one, keeping its level. Call once, at startup.
+    static void enableAsync();
+    static void enableAsync(const AsyncOptions& options);
+    static void setSessionLimits(const SessionLimits& limits);
+    static SessionLimits getSessionLimits();
+
+    // Messages dropped by session limiters since startup
+    static uint64_t suppressedMessages();
+    // Messages the async queue discarded because it was full; 0 when not async
+    static uint64_t droppedMessages();
+
+private:
+    friend class LogLimiter;
+    static std::atomic<uint64_t> suppressed;
+};
+
+// One per session; thread-safe
+class LogLimiter {
+public:
+    // True if a message may be logged now; otherwise counts it as suppressed
+    bool allow();
+    uint64_t suppressed() const { return m_suppressed.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex;
+    double m_tokens = -1.0;  // filled on first use
+    std::chrono::steady_clock::time_point m_refilledAt;
+    uint64_t m_overLimit = 0;
+    std::atomic<uint64_t> m_suppressed{0};
+};
+
+#endif // LOGGING_H
@@ -0,0 +1,60 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "I_MetricsSink.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Process-wide hook the modules report through. With no sink installed every call is a
+// single atomic load.
+class Metrics {
+public:
+    static Metrics& getInstance();
+
+    // Replaces the sink; nullptr turns reporting off
+    void setSink(std::shared_ptr<I_MetricsSink> sink);
+    std::shared_ptr<I_MetricsSink> getSink() const { return std::atomic_load(&m_sink); }
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void recordLatency(Metric metric, const MetricLabels& labels, double milliseconds);
+    void recordLatency(Metric metric, const MetricLabels& labels, std::chrono::steady_clock::time_point since);
+    void incrementCounter(Metric metric, const MetricLabels& labels, uint64_t delta = 1);
+
+private:
+    Metrics() = default;
+
+    std::atomic<bool> m_enabled{false};
+    std::mutex mutex;  // serialises setSink(); readers use atomic_load
+    std::shared_ptr<I_MetricsSink> m_sink;
+};
+
+// A module's labels resolved against the installed sink on first use and kept until the sink
+// is replaced or invalidate() is called, e.g. after a pooled module is rebound to another session.
+class MetricsSeries {
+public:
+    explicit MetricsSeries(std::function<MetricLabels()> labels) : m_labels(std::move(labels)) {}
+
+    void recordLatency(Metric metric, double milliseconds);
+    void recordLatency(Metric metric, std::chrono::steady_clock::time_point since);
+    void incrementCounter(Metric metric, uint64_t delta = 1);
+    void invalidate() { ++m_generation; }
+
+private:
+    struct Binding {
+        std::shared_ptr<I_MetricsSink> sink;
+        std::shared_ptr<I_MetricsSink::Series> series;
+        uint64_t generation;
+    };
+    // nullptr when reporting is off; holding the binding keeps its sink alive
+    std::shared_ptr<const Binding> resolve();
+
+    std::function<MetricLabels()> m_labels;
+    std::atomic<uint64_t> m_generation{0};
+    std::shared_ptr<const Binding> m_binding;  // atomic_load / atomic_store
+};
+
+#endif // METRICS_H
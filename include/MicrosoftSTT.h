@@ -1,7 +1,10 @@
 #ifndef MICROSOFT_STT_H
 #define MICROSOFT_STT_H
 
+#include "AzureSpeech.h"
 #include "STTModuleBase.h"
+#include <condition_variable>
+#include <future>
 #include <iostream>
 #include <speechapi_cxx.h>
 
@@ -11,17 +14,38 @@ using namespace Microsoft::CognitiveServices::Speech::Audio;
 
 class MicrosoftSTT : public STTModuleBase, public std::enable_shared_from_this<MicrosoftSTT> {
 public:
-    using STTModuleBase::STTModuleBase;
+    MicrosoftSTT(const std::string& sid, std::function<void(std::string&)> cb, std::string lang);
+    ~MicrosoftSTT() override;
     void InitialiseSTTModule(const std::string& subscriptionKey, const std::string& region) override;
     void ImplStreamAudioData(std::vector<uint8_t> audioData) override;
     void ImplStartRecognition() override;
     void ImplStopRecognition() override;
     void ImplRecognize() override;
+    const char* VendorName() const override { return "microsoft"; }
+protected:
+    void ImplBeginBulk() override;
+    void ImplStreamBulk(const uint8_t* audioData, size_t size) override;
+    void ImplEndBulk() override;
+    void ImplAbortBulk() override;
+    bool ImplControlSettled() override;
 private:
+    // Runs a start (or stop) after the previous one without blocking the audio thread
+    void QueueRecognitionChange(bool start);
+
+    std::mutex controlMutex;
+    std::shared_future<void> lastControl;  // the most recent start or stop, chained after the earlier ones
     std::shared_ptr<SpeechConfig> speechConfig;
     std::shared_ptr<AudioConfig> audioConfig;
     std::shared_ptr<SpeechRecognizer> recognizer;
     std::shared_ptr<PushAudioInputStream> pushStream;
+
+    // Bulk runs get their own push stream and recognizer, since closing a stream ends it for good
+    std::shared_ptr<PushAudioInputStream> bulkStream;
+    std::shared_ptr<SpeechRecognizer> bulkRecognizer;
+    std::mutex bulkDoneMutex;
+    std::condition_variable bulkDoneCV;
+    bool bulkDone = false;
+    std::string bulkError;
 };
 
 #endif // MICROSOFT_STT_H
@@ -1,6 +1,7 @@
 #ifndef MICROSOFTTTS_H
 #define MICROSOFTTTS_H
 
+#include "AzureSpeech.h"
 #include "TTSModuleBase.h"
 
 #include <iostream>
@@ -13,11 +14,18 @@ using namespace Microsoft::CognitiveServices::Speech::Audio;
 class MicrosoftTTS : public TTSModuleBase {
 public:
     using TTSModuleBase::TTSModuleBase;
+    ~MicrosoftTTS() override;
     bool Initialise(const std::string& apiKey, const std::string& region) override;
     void ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) override; 
+    const char* VendorName() const override { return "microsoft"; }
+protected:
+    void ImplCancelSynthesis() override;
 private:
-    std::shared_ptr<SpeechConfig> speechConfig;
+    SpeechSynthesisOutputFormat selectOutputFormat();
+
+    // Leased from AzureSpeech with its connection already open; handed back on destruction
     std::shared_ptr<SpeechSynthesizer> synthesizer;
+    std::atomic<bool> synthesizerFailed{false};
     std::unique_ptr<std::thread> synthesisThread;
 };
 
@@ -0,0 +1,126 @@
+#ifndef MODULE_POOL_H
+#define MODULE_POOL_H
+
+#include "I_STTModule.h"
+#include "I_TTSModule.h"
+#include "STTModuleBase.h"
+#include "TTSModuleBase.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Pre-initialised STT and TTS modules, kept warm per provider and voice
+    (TTS) or provider and language (STT). Call setup leases one instead of
+    constructing a module, starting its thread and doing the vendor setup
+    (SpeechConfig, sockets, voice lookups) on the caller's path.
+
+        ModulePool::TTSPoolSpec spec;
+        spec.provider = "Deepgram";
+        spec.voiceName = "aura-asteria-en";
+        spec.apiKey = key;
+        ModulePool::getInstance().addTTSPool(spec);
+        auto tts = TTSFactory::LeaseTTSModule("Deepgram", sid, callback, "aura-asteria-en");
+
+    Dropping the leased pointer hands the module back: its speech is
+    cancelled or its recognition stopped, and once idle it waits for the next
+    session. A background thread keeps every pool topped up to `warm` idle
+    modules. When a pool is empty, the lease builds a module on the caller's
+    thread instead (a cold lease).
+*/
+class ModulePool {
+public:
+    struct TTSPoolSpec {
+        std::string provider;           // as registered with TTSFactory
+        std::string voiceName;
+        std::string apiKey;
+        std::string region;
+        int outputSampleRate = 8000;
+        size_t warm = 4;                // idle modules kept ready
+        size_t maxIdle = 16;            // returned modules beyond this are destroyed
+    };
+
+    struct STTPoolSpec {
+        std::string provider;           // as registered with STTFactory
+        STTConfig config;               // language, apiKey, region and sampleRate are used
+        size_t warm = 4;
+        size_t maxIdle = 16;
+    };
+
+    struct Stats {
+        uint64_t warmLeases = 0;    // served from an idle module
+        uint64_t coldLeases = 0;    // built on the caller's thread
+        uint64_t returned = 0;      // back in a pool after a session
+        uint64_t discarded = 0;     // failed to initialise, never went idle, or over maxIdle
+        size_t idle = 0;
+    };
+
+    static ModulePool& getInstance();
+
+    // Adds (or replaces the spec of) the pool for provider/voice and starts filling it in the background
+    void addTTSPool(const TTSPoolSpec& spec);
+    void addSTTPool(const STTPoolSpec& spec);
+
+    // Throw std::runtime_error if no pool was added for the key or a cold module fails to initialise
+    std::shared_ptr<I_TTSModule> leaseTTS(const std::string& provider, const std::string& voiceName,
+                                          const std::string& sid, std::function<void(const std::vector<uint8_t>&)> callback);
+    std::shared_ptr<I_STTModule> leaseSTT(const std::string& provider, const std::string& language,
+                                          const std::string& sid, std::function<void(std::string&)> callback);
+
+    Stats getStats();
+    // Destroys idle modules and stops refilling; leased modules are destroyed when dropped
+    void shutdown();
+
+private:
+    ModulePool() = default;
+    ~ModulePool();
+
+    template <typename Module, typename Spec>
+    struct Pool {
+        Spec spec;
+        std::deque<std::shared_ptr<Module>> idle;
+        size_t building = 0;
+        std::chrono::steady_clock::time_point retryAfter;  // set when building a module failed
+    };
+
+    // Modules back from a session, waiting for their cancelled speech or stop to drain
+    struct Returning {
+        std::shared_ptr<TTSModuleBase> tts;
+        std::shared_ptr<STTModuleBase> stt;
+        std::string key;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    std::shared_ptr<TTSModuleBase> buildTTS(const TTSPoolSpec& spec);
+    std::shared_ptr<STTModuleBase> buildSTT(const STTPoolSpec& spec);
+    void giveBack(Returning returning);
+    void ensureThread();
+    void maintain();
+    // One step of maintain(); returns true if it did any work
+    bool refillOnce();
+    bool drainReturning();
+
+    std::mutex mutex;
+    std::condition_variable maintainCV;
+    bool stopMaintenance = false;
+    bool shutDown = false;
+    std::thread maintenanceThread;
+
+    std::map<std::string, Pool<TTSModuleBase, TTSPoolSpec>> ttsPools;  // by provider + "/" + voice
+    std::map<std::string, Pool<STTModuleBase, STTPoolSpec>> sttPools;  // by provider + "/" + language
+    std::vector<Returning> returning;
+    std::atomic<uint64_t> serial{0};  // numbers the session ids modules are built with
+    Stats stats;
+};
+
+#endif // MODULE_POOL_H
@@ -0,0 +1,94 @@
+#ifndef PROMETHEUSEXPORTER_H
+#define PROMETHEUSEXPORTER_H
+
+#include "I_MetricsSink.h"
+#include "TTSCacheStats.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+/*
+    Metrics sink that aggregates module telemetry into Prometheus histograms
+    and counters and renders them in the text exposition format. There is no
+    HTTP server: hosts serve Render() themselves, write it to a file for
+    node_exporter's textfile collector, or have it pushed to a callback
+    periodically.
+
+        auto exporter = std::make_shared<PrometheusExporter>();
+        Metrics::getInstance().setSink(exporter);
+        exporter->StartPeriodic(std::chrono::seconds(15), [](const std::string& text) { ... });
+
+    Latencies are exported in seconds. The session label is off by default
+    since one series per call quickly overwhelms a Prometheus server.
+
+    Each label set is looked up once, by Resolve(); recording through the
+    returned series only touches atomics.
+*/
+class PrometheusExporter : public I_MetricsSink {
+public:
+    struct Options {
+        bool sessionLabel = false;       // add session="<sid>" to every series
+        bool includeCacheStats = false;  // append TTSCache::getStats() to Render()
+    };
+
+    PrometheusExporter();
+    explicit PrometheusExporter(const Options& options);
+    ~PrometheusExporter() override;
+
+    void RecordLatency(Metric metric, const MetricLabels& labels, double milliseconds) override;
+    void IncrementCounter(Metric metric, const MetricLabels& labels, uint64_t delta) override;
+    std::shared_ptr<Series> Resolve(const MetricLabels& labels) override;
+
+    std::string Render();
+    static std::string RenderCacheStats(const TTSCacheStats& stats);
+
+    // Writes Render() next to `path` and renames it into place, so readers never see a partial file
+    bool WriteFile(const std::string& path);
+    // Hands Render() to `output` every `interval` on a background thread until Stop()
+    void StartPeriodic(std::chrono::milliseconds interval, std::function<void(const std::string&)> output);
+    void Stop();
+
+private:
+    static constexpr size_t bucketCount = 12;  // last is +Inf
+    static constexpr size_t metricCount = static_cast<size_t>(Metric::BargeInReaction) + 1;
+    static const std::array<double, bucketCount - 1> bucketBoundsSeconds;
+
+    struct Cells {
+        std::atomic<bool> used{false};  // rendered only once something was recorded
+        std::array<std::atomic<uint64_t>, bucketCount> buckets{};  // per bucket, not cumulative
+        std::atomic<uint64_t> sumNanos{0};
+        std::atomic<uint64_t> counter{0};
+    };
+
+    // Every metric for one label set
+    class LabelSeries : public Series {
+    public:
+        void RecordLatency(Metric metric, double milliseconds) override;
+        void IncrementCounter(Metric metric, uint64_t delta) override;
+
+        std::array<Cells, metricCount> cells;
+    };
+
+    std::string labelText(const MetricLabels& labels) const;
+    std::shared_ptr<LabelSeries> findSeries(const MetricLabels& labels);
+
+    Options m_options;
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<LabelSeries>> series;  // by label text, never removed
+
+    std::mutex periodicMutex;
+    std::condition_variable periodicCV;
+    bool stopPeriodic = false;
+    std::thread periodicThread;
+};
+
+#endif // PROMETHEUSEXPORTER_H
@@ -2,11 +2,23 @@
 #define STT_FACTORY_H
 
 #include "I_STTModule.h"
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 class STTFactory {
 public:
+    using Creator = std::function<std::shared_ptr<I_STTModule>(const std::string& stream_sid, std::function<void(std::string&)> callback, std::string language)>;
+
     static std::shared_ptr<I_STTModule> CreateSTTModule(const std::string& provider, const std::string& stream_sid, std::function<void(std::string&)> callback, std::string language);
+    // Initialised module from the ModulePool added for provider/language; dropping it returns it to the pool
+    static std::shared_ptr<I_STTModule> LeaseSTTModule(const std::string& provider, const std::string& stream_sid, std::function<void(std::string&)> callback, std::string language);
+
+    // Adds or replaces a provider. "Microsoft" and "Deepgram" are built in; modules that should be
+    // pooled must derive from STTModuleBase.
+    static void RegisterProvider(const std::string& provider, Creator creator);
+    static std::vector<std::string> Providers();
 };
 
 #endif // STT_FACTORY_H
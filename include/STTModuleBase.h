@@ -2,7 +2,15 @@
 #define STT_MODULE_BASE_H
 
 #include "I_STTModule.h"
+#include "AudioResampler.h"
+#include "Metrics.h"
+#include "Logging.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -10,31 +18,125 @@
 #include <spdlog/spdlog.h>
 
 
+// A final transcript with its position in the audio passed to TranscribeAudio
+struct TranscriptSegment {
+    double startMs = 0;
+    double endMs = 0;
+    std::string text;
+};
+
 class STTModuleBase : public I_STTModule {
+public:
+    struct BulkOptions {
+        int frameMs = 100;                           // audio per vendor write
+        size_t maxBufferedBytes = 512 * 1024;        // writes wait while the vendor socket holds more unsent
+        std::chrono::milliseconds readyTimeout{10000};    // connect and start
+        std::chrono::milliseconds finishTimeout{120000};  // end of audio until the last transcript
+    };
+
 protected:
     std::string stream_sid;
     std::function<void(std::string&)> callback;
     std::string language;
-    std::queue<std::tuple<std::string, std::function<void(std::string&)>,std::vector<uint8_t>>> audioQueue;
+    std::queue<std::tuple<std::string, std::function<void(std::string&)>,std::vector<uint8_t>,std::chrono::steady_clock::time_point>> audioQueue;
     std::mutex queueMutex;
     std::condition_variable queueCV;
     bool stopProcessing = false;
     std::thread processingThread;
 
+    // Caller audio arrives at m_inputSampleRate; vendors set m_vendorSampleRate to what their stream accepts.
+    // Written by Configure/InitialiseSTTModule on the caller's thread, read by the processing thread.
+    std::atomic<int> m_inputSampleRate{8000};
+    std::atomic<int> m_vendorSampleRate{8000};
+    std::unique_ptr<AudioResampler> m_inputResampler;
+
+    // Shared by this session's repeated log lines (transcripts, speech events)
+    LogLimiter m_logLimiter;
+
+    // Vendors whose start and stop complete on their own threads set this and report
+    // RecognitionStarted/RecognitionStopped themselves; otherwise the base reports them
+    // once ImplStartRecognition/ImplStopRecognition return.
+    bool m_asyncStartStop = false;
+
     void ProcessAudioStream();
     void RecognisedText(std::string& text);
+    void RecognitionEvent(STTEventType type, const std::string& detail = "");
+    // Vendors that know where a final transcript lies in the audio report it here instead of
+    // RecognisedText; offsets are from the start of the recognition
+    void RecognisedSegment(std::string& text, double startMs, double endMs);
+    // Stops and joins the processing thread; for vendor destructors that must outlive it. Safe to call twice.
+    void StopProcessing();
 
     virtual void ImplStreamAudioData(std::vector<uint8_t> audioData) = 0;
     virtual void ImplStartRecognition() = 0;
     virtual void ImplStopRecognition() = 0;
     virtual void ImplRecognize() = 0;
+    // False while a start or stop the vendor completes on its own thread (m_asyncStartStop) is
+    // still running; IsIdle() and Rebind() treat the module as busy until then. Must not block.
+    virtual bool ImplControlSettled() { return true; }
+
+    // Bulk transcription (TranscribeAudio), on the caller's thread. ImplBeginBulk connects and
+    // returns once the vendor accepts audio, ImplStreamBulk writes as fast as the vendor's flow
+    // control allows (m_bulkOptions), and ImplEndBulk signals the end of the audio and returns
+    // once the last transcript has arrived. Each throws std::runtime_error on failure, after
+    // which ImplAbortBulk releases whatever the run still holds (connection, recognizer).
+    // The default ImplBeginBulk throws: the vendor has no bulk mode.
+    virtual void ImplBeginBulk();
+    virtual void ImplStreamBulk(const uint8_t* audioData, size_t size) { (void)audioData; (void)size; }
+    virtual void ImplEndBulk() {}
+    virtual void ImplAbortBulk() {}
+    BulkOptions m_bulkOptions;
 
 public:
     STTModuleBase(const std::string& sid, std::function<void(std::string&)> cb, std::string lang);
     virtual ~STTModuleBase();
+    void Configure(const STTConfig& config) override;
     void StreamAudioData(std::vector<uint8_t> audioData) override;
     void StartRecognition() override;
     void StopRecognition() override;
+    Completion<std::string> NextUtterance() override;
+    void SetEventCallback(std::function<void(const STTEvent&)> callback) override;
+
+    // Short vendor id used to label metrics ("microsoft", "deepgram", ...)
+    virtual const char* VendorName() const = 0;
+    // Transcribes a recording without real-time pacing and returns its final transcripts in
+    // order. Blocks until done. `audio` is PCM at the configured sample rate. Throws
+    // std::runtime_error if the vendor has no bulk mode or fails, or if recognition is running.
+    std::vector<TranscriptSegment> TranscribeAudio(const uint8_t* audio, size_t size);
+    std::vector<TranscriptSegment> TranscribeAudio(const uint8_t* audio, size_t size, const BulkOptions& options);
+
+    MetricLabels MetricsLabels() { return {VendorName(), language, SessionId()}; }
+    // stream_sid for threads that may run while ModulePool rebinds an idle module (vendor callbacks)
+    std::string SessionId();
+    const std::string& Language() const { return language; }
+
+    // Module pooling (see ModulePool). ResetForReuse() stops recognition if it was started; once
+    // IsIdle(), Rebind() attaches the module to another session. Rebind fails on a busy module.
+    void ResetForReuse();
+    bool IsIdle();
+    bool Rebind(const std::string& sid, std::function<void(std::string&)> cb);
+
+private:
+    // Resolves every NextUtterance() handed out so far
+    void ResolveUtterances(const std::string& text);
+
+    bool m_busy = false;  // a task is being processed; guarded by queueMutex
+    std::atomic<bool> m_recognitionStarted{false};
+    std::atomic<bool> m_bulkActive{false};
+
+    std::mutex bulkMutex;
+    std::vector<TranscriptSegment> m_bulkSegments;
+
+    std::mutex eventMutex;
+    std::function<void(const STTEvent&)> eventCallback;
+
+    std::mutex callbackMutex;  // guards callback between vendor threads and Rebind()
+    std::mutex sessionMutex;   // guards stream_sid against Rebind()
+
+    std::mutex utteranceMutex;
+    std::vector<Completion<std::string>> pendingUtterances;
+
+    MetricsSeries m_metrics{[this] { return MetricsLabels(); }};
 };
 
 #endif // STT_MODULE_BASE_H
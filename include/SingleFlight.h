@@ -0,0 +1,70 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    In-process single-flight table for TTS synthesis, keyed by the cache hash.
+
+    The first session to miss the cache for a key becomes the leader and calls the
+    vendor; sessions that miss while that call is running join its flight and play
+    the audio the leader publishes instead of calling the vendor themselves. Chunks
+    are replayed to each follower in order as they are published, so a follower
+    that joins late still gets the whole prompt. The leader saves to TTSCache before
+    finishing, so sessions arriving after the flight ends hit the cache.
+*/
+class SingleFlight {
+public:
+    using AudioPtr = std::shared_ptr<const std::vector<uint8_t>>;
+
+    class Flight {
+    public:
+        // Leader side
+        void publish(AudioPtr chunk);
+        size_t chunkCount();
+
+        // Follower side: plays every published chunk through `onChunk` until the leader
+        // finishes. Returns true if the leader succeeded; false if it failed or `stopped` returned true.
+        bool follow(const std::function<void(const std::vector<uint8_t>&)>& onChunk,
+                    const std::function<bool()>& stopped);
+
+    private:
+        friend class SingleFlight;
+        void finish(bool success);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<AudioPtr> chunks;
+        bool done = false;
+        bool succeeded = false;
+    };
+
+    static SingleFlight& getInstance();
+
+    // Returns the flight for `key`, creating it when none is running; `leader` is set for the creator.
+    std::shared_ptr<Flight> join(const std::string& key, bool& leader);
+    // Leader only: removes the flight from the table and releases its followers.
+    void finish(const std::string& key, const std::shared_ptr<Flight>& flight, bool success);
+
+    uint64_t getLeaderCount() const { return leaders.load(); }
+    uint64_t getFollowerCount() const { return followers.load(); }
+
+private:
+    SingleFlight() = default;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+    std::atomic<uint64_t> leaders{0};
+    std::atomic<uint64_t> followers{0};
+};
+
+#endif // SINGLEFLIGHT_H
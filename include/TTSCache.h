@@ -3,47 +3,177 @@
 #define TTSCACHE_H
 
 #include <unordered_map>
+#include <array>
 #include <list>
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <queue>
 #include <thread>
 #include <condition_variable>
-#include <iomanip>
 #include <iostream>
-#include <openssl/sha.h>  // For SHA-256 hashing
+
+#include "CachedAudio.h"
+#include "TTSCacheStats.h"
+#include "TTSSegmentStore.h"
+#include "TTSSharedTier.h"
 
 class TTSCache {
 public:
+    using AudioPtr = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // When queued disk writes reach stable storage
+    enum class Durability {
+        None,       // left to the OS page cache (default)
+        Batch,      // one fdatasync per write-behind batch
+        EveryWrite  // fdatasync after every record
+    };
+
+    // Rules applied to segment text before it is hashed into a key
+    struct TextNormalization {
+        bool collapseWhitespace = true;  // trim, and turn runs of whitespace into one space
+        bool foldCase = false;           // ASCII lower-case
+        bool stripPunctuation = false;   // drop ASCII punctuation; vendors may voice it differently
+    };
+
+    // Per-label lookup and save counters behind getStats().labels. Updated without a lock, so
+    // callers on the hot path resolve their label once and pass the pointer to every lookup.
+    struct LabelCounters {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> saves{0};
+        std::atomic<uint64_t> savedBytes{0};
+    };
+
+    // The disk tier lives in ./tts_cache/, or in VOICEKIT_TTS_CACHE_DIR when set before the first call
     static TTSCache& getInstance();
 
     bool isCached(const std::string& key);
-    std::vector<uint8_t> getCachedAudio(const std::string& key);
-    void saveToCache(const std::string& key, const std::vector<uint8_t>& audioData);
+    // Zero-copy view of the cached audio (memory buffer or disk mapping); empty on a miss.
+    // `label` (e.g. "vendor/voice") attributes the lookup in getStats().labels.
+    // `normalizedKey` marks keys whose text was changed by normalization (see makeKey) for the stats.
+    CachedAudio getCachedAudio(const std::string& key, const std::string& label = "", bool normalizedKey = false);
+    void saveToCache(const std::string& key, const std::vector<uint8_t>& audioData, const std::string& label = "");
+    // Shares the buffer with the memory tier and the disk writer instead of copying it
+    void saveToCache(const std::string& key, AudioPtr audio, const std::string& label = "");
+    // Same, counting into counters from labelCounters() (nullptr counts nothing); takes no stats lock
+    CachedAudio getCachedAudio(const std::string& key, LabelCounters* counters, bool normalizedKey = false);
+    void saveToCache(const std::string& key, AudioPtr audio, LabelCounters* counters);
+    // Counters for `label`, created on first use and kept for the life of the cache; nullptr for ""
+    LabelCounters* labelCounters(const std::string& label);
+
+    // 128-bit MurmurHash3 of everything that determines the audio, as 32 hex characters
+    static std::string generateKey(const std::string& vendor, const std::string& voiceName, const std::string& format,
+                                   int sampleRate, const std::string& text);
+    static std::string normalizeText(const std::string& text, const TextNormalization& rules);
+    // generateKey over the text after the configured normalization; `normalized` reports whether it changed
+    std::string makeKey(const std::string& vendor, const std::string& voiceName, const std::string& format,
+                        int sampleRate, const std::string& text, bool* normalized = nullptr);
+    void setTextNormalization(const TextNormalization& rules);
+    TextNormalization getTextNormalization();
 
-    static std::string generateHash(const std::string& vendor, const std::string& voiceName, const std::string& text);
-    static std::string getCacheFilePath(const std::string& hash);
+    // Memory tier is bounded in bytes (default 64 MB) and evicts least recently used entries.
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+    size_t getMemoryResidentBytes();
+    // Fraction of lookups answered by the memory tier since startup
+    double getMemoryHitRatio() const;
+
+    // Store new disk records deflate-compressed (off by default); ratio and per-hit decode cost are in the stats
+    void setDiskCompression(bool enabled, int level = 1);
+    TTSSegmentStore::CompressionStats getDiskCompressionStats() const;
+    // Optional host-wide tier in POSIX shared memory, used by every worker process that enables it under
+    // the same name. Once enabled, saves go to the shared arena instead of this process's memory tier, so
+    // a prompt is held once per host; lookups check it after the memory tier. Call before sessions start.
+    bool enableSharedTier(const std::string& name = "/voicekit-tts-cache", size_t arenaBytes = 256 * 1024 * 1024);
+    bool isSharedTierEnabled() const;
+
+    // Disk tier bound in bytes (0 = unbounded, the default). Past it, or when the volume has less than
+    // `minFreeBytes` free, a background pass evicts entries not hit recently, oldest segment first.
+    void setDiskBudget(uint64_t bytes, uint64_t minFreeBytes = 1ull << 30);
+    uint64_t getDiskBudget() const;
+    // Disk keys are indexed in the background at startup; until then older entries read as misses
+    bool isDiskIndexLoaded() const;
+
+    // Disk writes are queued and coalesced per key; the queue is bounded in bytes and
+    // saves that would exceed it skip the disk tier (they stay in memory).
+    void setDurability(Durability durability);
+    void setMaxPendingWriteBytes(size_t bytes);
+    size_t getPendingWriteBytes();
+    uint64_t getCoalescedWrites() const;
+    uint64_t getDroppedWrites() const;
+
+    // Consistent-enough snapshot of every counter for a host process to scrape
+    TTSCacheStats getStats();
 
 private:
     TTSCache();
     ~TTSCache();
 
-    std::unordered_map<std::string, std::vector<uint8_t>> memoryCache;
-    std::list<std::string> cacheOrder;
-    std::queue<std::pair<std::string, std::vector<uint8_t>>> fileWriteQueue;
-    size_t maxCacheSize = 100; // Keep only 100 items in-memory
+    // Memory tier is split into shards with their own lock so sessions only contend
+    // when they hash to the same shard. Locks guard map updates and pointer copies;
+    // audio is copied and disk is touched only after the lock is released.
+    // Each shard is an LRU list (front = most recent) with a map into it, so hits
+    // promote in O(1) and the shard evicts from the back once over its byte share.
+    struct Entry {
+        std::string key;
+        AudioPtr audio;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> memoryCache;
+        size_t bytes = 0;
+    };
+    static constexpr size_t shardCount = 16;
+
+    std::array<Shard, shardCount> shards;
+    std::atomic<size_t> memoryBudgetBytes{64 * 1024 * 1024};
+    std::atomic<uint64_t> memoryHits{0};
+    std::atomic<uint64_t> memoryMisses{0};
+    std::atomic<uint64_t> memoryEvictions{0};
+    std::atomic<uint64_t> diskHits{0};
+    std::atomic<uint64_t> diskMisses{0};
+    std::atomic<uint64_t> normalizedLookups{0};
+    std::atomic<uint64_t> normalizedHits{0};
+    std::mutex normalizationMutex;
+    TextNormalization textNormalization;
+    LatencyHistogram memoryLookupLatency;
+    LatencyHistogram diskLookupLatency;
+    LatencyHistogram sharedLookupLatency;
+    std::atomic<uint64_t> sharedHits{0};
+    std::atomic<uint64_t> sharedMisses{0};
+    std::mutex sharedTierMutex;
+    std::unique_ptr<TTSSharedTier> sharedTierOwner;
+    std::atomic<TTSSharedTier*> sharedTier{nullptr};  // set once; lookups read it without the lock
+    std::mutex labelMutex;  // guards the map only; the counters are atomics
+    std::map<std::string, std::unique_ptr<LabelCounters>> labelStats;
+    TTSSegmentStore diskStore;
+
+    // Write-behind: keys in arrival order plus the latest audio per key, so a key saved
+    // again before it is written costs one write. The single writer drains it in batches.
+    std::queue<std::string> writeOrder;
+    std::unordered_map<std::string, AudioPtr> pendingWrites;
+    size_t pendingWriteBytes = 0;
+    std::atomic<size_t> maxPendingWriteBytes{64 * 1024 * 1024};
+    std::atomic<Durability> durability{Durability::None};
+    std::atomic<uint64_t> coalescedWrites{0};
+    std::atomic<uint64_t> droppedWrites{0};
+    std::atomic<uint64_t> completedWrites{0};
+    std::atomic<uint64_t> writeErrors{0};
     bool stopThreads;
-    size_t threadCount; // Number of worker threads
-    std::vector<std::thread> workers;
-    std::mutex cacheMutex;
+    std::thread writerThread;
     std::mutex queueMutex;
     std::condition_variable queueCondition;
 
-    void evictOldest();
+    Shard& shardFor(const std::string& key);
+    void evictToBudget(Shard& shard);
     void fileWriterThread();
 };
 
@@ -0,0 +1,136 @@
+#ifndef TTSCACHESTATS_H
+#define TTSCACHESTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Lock-free latency histogram with fixed power-of-two buckets from 250 ns to ~16 ms.
+class LatencyHistogram {
+public:
+    static constexpr size_t bucketCount = 18;  // last bucket is +Inf
+
+    struct Snapshot {
+        std::array<uint64_t, bucketCount> upperBoundsNanos{};  // 0 for the +Inf bucket
+        std::array<uint64_t, bucketCount> counts{};            // per bucket, not cumulative
+        uint64_t count = 0;
+        uint64_t sumNanos = 0;
+
+        double averageMicros() const { return count ? sumNanos / 1000.0 / count : 0.0; }
+        // Upper bound of the bucket holding the q-th quantile, in microseconds
+        double quantileMicros(double q) const {
+            if (count == 0) return 0.0;
+            uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1, seen = 0;
+            for (size_t i = 0; i < bucketCount; ++i) {
+                seen += counts[i];
+                if (seen >= rank) return upperBoundsNanos[i] ? upperBoundsNanos[i] / 1000.0 : upperBoundsNanos[i - 1] / 1000.0;
+            }
+            return upperBoundsNanos[bucketCount - 2] / 1000.0;
+        }
+    };
+
+    static constexpr uint64_t upperBoundNanos(size_t bucket) {
+        return bucket + 1 < bucketCount ? uint64_t(250) << bucket : 0;
+    }
+
+    void record(uint64_t nanos) {
+        size_t bucket = 0;
+        while (bucket + 1 < bucketCount && nanos > upperBoundNanos(bucket)) ++bucket;
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (size_t i = 0; i < bucketCount; ++i) {
+            s.upperBoundsNanos[i] = upperBoundNanos(i);
+            s.counts[i] = counts[i].load(std::memory_order_relaxed);
+        }
+        s.count = total.load(std::memory_order_relaxed);
+        s.sumNanos = sum.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, bucketCount> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+};
+
+// Point-in-time view of TTSCache counters, returned by TTSCache::getStats() for a host to scrape.
+// Counters are cumulative since startup; bytes and depths are current values.
+struct TTSCacheStats {
+    struct LabelStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t saves = 0;
+        uint64_t savedBytes = 0;
+    };
+
+    // Memory tier
+    uint64_t memoryHits = 0;
+    uint64_t memoryMisses = 0;
+    uint64_t memoryEvictions = 0;
+    uint64_t memoryEntries = 0;
+    uint64_t memoryResidentBytes = 0;
+    uint64_t memoryBudgetBytes = 0;
+
+    // Shared-memory tier (lookups that reached it, i.e. memory misses). Inserts count every process.
+    bool sharedTierEnabled = false;
+    uint64_t sharedHits = 0;
+    uint64_t sharedMisses = 0;
+    uint64_t sharedInserts = 0;
+    uint64_t sharedTornReads = 0;  // hits lost because the record was overwritten while copying
+    uint64_t sharedArenaBytes = 0;
+
+    // Disk tier (lookups that reached it, i.e. memory and shared misses)
+    uint64_t diskHits = 0;
+    uint64_t diskMisses = 0;
+    uint64_t diskEntries = 0;
+    uint64_t diskTotalBytes = 0;
+    uint64_t diskLiveBytes = 0;
+    bool diskIndexLoaded = false;
+    uint64_t compressedEntries = 0;
+    double compressionRatio = 1.0;
+    double averageDecodeMicros = 0.0;
+    uint64_t diskBudgetBytes = 0;     // 0 = unbounded
+    uint64_t diskEvictedEntries = 0;
+    uint64_t diskEvictedBytes = 0;
+    uint64_t diskReclaimedBytes = 0;  // segment bytes freed by eviction, dead records included
+    uint64_t diskEvictionPasses = 0;
+    double diskReclaimMillis = 0.0;   // total time spent evicting
+
+    // Write-behind queue
+    uint64_t writeQueueDepth = 0;
+    uint64_t writeQueueBytes = 0;
+    uint64_t writesCompleted = 0;
+    uint64_t writesCoalesced = 0;
+    uint64_t writesDropped = 0;
+    uint64_t writeErrors = 0;
+
+    // Lookups whose key text was changed by normalization, and how many of them hit. Those hits
+    // are an upper bound on what normalization gains; compare hit ratios with it toggled for the exact gain.
+    uint64_t normalizedLookups = 0;
+    uint64_t normalizedHits = 0;
+
+    LatencyHistogram::Snapshot memoryLookupLatency;  // lookups answered by the memory tier
+    LatencyHistogram::Snapshot sharedLookupLatency;  // lookups that went to the shared tier, hit or miss
+    LatencyHistogram::Snapshot diskLookupLatency;    // lookups that went to the disk tier, hit or miss
+
+    // Keyed by the "vendor/voice" label callers pass to getCachedAudio and saveToCache
+    std::map<std::string, LabelStats> labels;
+
+    double memoryHitRatio() const {
+        uint64_t lookups = memoryHits + memoryMisses;
+        return lookups ? static_cast<double>(memoryHits) / lookups : 0.0;
+    }
+    double overallHitRatio() const {
+        uint64_t lookups = memoryHits + memoryMisses;
+        return lookups ? static_cast<double>(memoryHits + sharedHits + diskHits) / lookups : 0.0;
+    }
+};
+
+#endif // TTSCACHESTATS_H
@@ -2,11 +2,26 @@
 #define TTSFACTORY_H
 
 #include "I_TTSModule.h"
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 class TTSFactory {
 public:
+    using Creator = std::function<std::shared_ptr<I_TTSModule>(const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName)>;
+
     static std::shared_ptr<I_TTSModule> CreateTTSModule(const std::string& provider, const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName);
+    // Primary and secondary must come from CreateTTSModule and be initialised already
+    static std::shared_ptr<I_TTSModule> CreateHedgedTTSModule(const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::shared_ptr<I_TTSModule> primary, std::shared_ptr<I_TTSModule> secondary, std::chrono::milliseconds firstAudioDeadline, std::chrono::milliseconds segmentDeadline = std::chrono::seconds(30));
+    // Initialised module from the ModulePool added for provider/voiceName; dropping it returns it to the pool
+    static std::shared_ptr<I_TTSModule> LeaseTTSModule(const std::string& provider, const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName);
+
+    // Adds or replaces a provider. "Microsoft", "Deepgram" and "Elevenlabs" are built in; modules
+    // that should be pooled must derive from TTSModuleBase.
+    static void RegisterProvider(const std::string& provider, Creator creator);
+    static std::vector<std::string> Providers();
 };
 
 #endif // TTSFACTORY_H
@@ -3,14 +3,21 @@
 
 #include "I_TTSModule.h"
 #include "TTSCache.h"
+#include "SingleFlight.h"
+#include "Metrics.h"
+#include "Logging.h"
 #include <thread>
 #include <chrono>
 #include <iostream>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <vector>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <map>
+#include <memory>
 #include <spdlog/spdlog.h>
 
 using namespace std;
@@ -18,27 +25,170 @@ using namespace std;
 class TTSModuleBase : public I_TTSModule {
 protected:
     std::string stream_sid;
-    std::string m_vendorName;
     std::string m_voiceName;
     std::function<void(const std::vector<uint8_t>&)> callback;
-    std::queue<std::pair<std::string,std::string>> textQueue;
+    // "start" speaks `text`; "template" speaks `pieces` spliced together
+    struct SpeakTask {
+        std::string command;
+        std::string text;
+        std::vector<std::string> pieces;
+        uint64_t epoch = 0;  // m_speechEpoch when queued; StopSpeak() moves it on
+        SpeakHandle handle;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+    std::queue<SpeakTask> textQueue;
     std::mutex queueMutex;
     std::condition_variable queueCV;
     bool stopProcessing = false;
     std::thread processingThread;
 
+    // Rate the vendor streams at vs. the rate we play out; audio is resampled when they differ.
+    int m_vendorSampleRate = 8000;
+    int m_outputSampleRate = 8000;
+
+    // Composite modules that never call a vendor themselves clear this, so vendor latency is
+    // reported once, by the module that made the request.
+    bool m_reportsVendorMetrics = true;
+
+    // PlayAudioBuffer sleeps one frame per chunk to pace delivery in real time; offline
+    // consumers (benchmarks, file rendering) clear it to get the chunks back-to-back.
+    bool m_pacePlayout = true;
+
+    // Shared by this session's repeated log lines (segments, playout, vendor progress)
+    LogLimiter m_logLimiter;
+
     void SynthesisedAudioData(std::vector<uint8_t> audioData,std::string hashKey,int latencyMs);
+    void PlayAudioBuffer(const uint8_t* audioData, size_t size);
+    void PlayAudioBuffer(const std::vector<uint8_t>& audioBuffer);
     virtual void ImplSynthesiseVoice(const std::string&, const std::string&) = 0;
+
+    // Vendors call this for every audio chunk they receive from the service.
+    void AudioChunkReceived();
+    // Vendors poll this while waiting on the service and give up without audio once it is set.
+    // Covers both CancelSynthesis() and StopSpeak() of the speech being synthesised.
+    bool IsSynthesisCancelled();
+    // True once StopSpeak() was called during the current speech; playout stops at the next chunk.
+    bool IsSpeechCancelled() const;
+    // Wakes the vendor's wait so it observes the cancellation; default does nothing.
+    virtual void ImplCancelSynthesis() {}
+    // Sentence-level segments of `text`, each cached and synthesised on its own
+    std::vector<std::string> splitText(const std::string& text);
+    // Stops and joins the synthesis thread. Vendors whose destructor hands resources to other
+    // sessions call it first, so the thread cannot use them afterwards; safe to call twice.
+    void StopProcessing();
+
 public:
+    using AudioSink = std::function<void(std::vector<uint8_t>, int)>;
+
     TTSModuleBase(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb, std::string voiceName);
     virtual ~TTSModuleBase();
-    void Speak(const std::string& text) override;
+    SpeakHandle Speak(const std::string& text) override;
     void StopSpeak() override;
+    void SetOutputSampleRate(int sampleRate) override;
+
+    // Speaks `templateText` with each {slot} replaced by values.at(slot), e.g.
+    // SpeakTemplate("Your balance is {amount} dollars.", {{"amount", "42"}}).
+    // The static fragments and each slot value are cached as separate phrases and spliced with
+    // short crossfades, so only pieces never spoken before go to the vendor. Throws
+    // std::invalid_argument for an unterminated or unknown slot.
+    SpeakHandle SpeakTemplate(const std::string& templateText, const std::map<std::string, std::string>& values);
+    // Caches each phrase (slot values such as numbers, dates, a template's fragments) without playing it.
+    // Runs on a background thread, not the speech queue: Speak() does not wait behind it beyond the one
+    // vendor request in flight, and StopSpeak() leaves it running. `done` resolves Completed once all
+    // are cached, Failed if the vendor returned nothing for some phrase.
+    SpeakHandle PrewarmPhrases(const std::vector<std::string>& phrases);
+    // Sends PrewarmPhrases() to `module` instead, e.g. one leased from ModulePool for the same vendor
+    // and voice, so prewarming never shares this session's vendor connection. The module is switched
+    // to this module's output rate; throws std::invalid_argument for another vendor or voice.
+    void SetPrewarmModule(std::shared_ptr<TTSModuleBase> module);
+    // Splits a template into its pieces in speaking order, with slots substituted; empty pieces are dropped
+    static std::vector<std::string> ExpandTemplate(const std::string& templateText,
+                                                   const std::map<std::string, std::string>& values);
+
+    // Composite modules drive a vendor through these instead of Speak.
+    // Runs one synthesis on the calling thread and hands the audio (at the output rate, with
+    // latency in ms) to `sink` instead of caching and playing it. `onFirstAudio` fires once on
+    // the first vendor chunk. Setting `*cancelled` and calling CancelSynthesis() aborts the call.
+    void SynthesiseSegment(const std::string& text, const std::string& hashKey,
+                           std::shared_ptr<std::atomic<bool>> cancelled,
+                           std::function<void()> onFirstAudio, AudioSink sink);
+    void CancelSynthesis();
+    // Key for `segment` as this module would synthesise it (vendor, voice, PCM format, output rate)
+    std::string CacheKey(const std::string& segment, bool* normalized = nullptr) const;
+    // Short vendor id used to label cache statistics ("microsoft", "deepgram", ...)
+    virtual const char* VendorName() const = 0;
+    std::string StatsLabel() const { return std::string(VendorName()) + "/" + m_voiceName; }
+    // TTSCache counters for StatsLabel(), resolved on first use so lookups take no stats lock
+    TTSCache::LabelCounters* CacheCounters();
+    MetricLabels MetricsLabels() { return {VendorName(), m_voiceName, SessionId()}; }
+    // stream_sid for threads that may run while ModulePool rebinds an idle module (vendor socket events)
+    std::string SessionId();
+    const std::string& VoiceName() const { return m_voiceName; }
+    int OutputSampleRate() const { return m_outputSampleRate; }
+
+    // Module pooling (see ModulePool). ResetForReuse() cancels queued and playing speech; once
+    // IsIdle(), Rebind() attaches the module to another session. Rebind fails on a busy module.
+    void ResetForReuse();
+    bool IsIdle();
+    bool Rebind(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb);
 
 private:
-    void PlayAudioBuffer(std::vector<uint8_t> audioBuffer);
     void ProcessText();
-    std::vector<std::string> splitText(const std::string& text);
+    SpeakHandle Enqueue(SpeakTask task);
+    void RunTask(const SpeakTask& task);
+    // Starts the time-to-first-audio clock for the vendor request about to be made
+    void BeginVendorRequest();
+    // Synthesise a cache miss, or play another session's in-flight synthesis of the same key
+    void SynthesiseOrJoin(const std::string& segment, const std::string& hashKey);
+    // Cached audio for `phrase`, synthesising and caching it on a miss or joining another session's
+    // synthesis of it; empty if the vendor fails or `stopped` returns true while waiting on a flight
+    CachedAudio FetchOrSynthesise(const std::string& phrase, const std::function<bool()>& stopped);
+    // Synthesises and caches `phrase` outside any flight; null if the vendor returned nothing
+    SingleFlight::AudioPtr SynthesisePhrase(const std::string& phrase, const std::string& hashKey);
+    void SpeakPieces(const std::vector<std::string>& pieces);
+    void PrewarmLoop();
+
+    // Background prewarming (PrewarmPhrases); the thread starts with the first request
+    struct PrewarmJob {
+        std::vector<std::string> phrases;
+        SpeakHandle handle;
+    };
+    std::deque<PrewarmJob> prewarmQueue;
+    std::mutex prewarmMutex;
+    std::condition_variable prewarmCV;
+    std::atomic<bool> stopPrewarm{false};
+    std::thread prewarmThread;
+    std::shared_ptr<TTSModuleBase> m_prewarmModule;
+
+    // One vendor request at a time: the speech and prewarm threads share the connection and the hooks below
+    std::mutex vendorMutex;
+    // Whether the request in flight is the speech thread's, so that StopSpeak() cancels it
+    std::atomic<bool> m_synthesisForSpeech{true};
+
+    // Per-call hooks installed by SynthesiseSegment
+    std::mutex synthesisHookMutex;
+    std::function<void()> m_firstAudioHook;
+    AudioSink m_audioSink;
+    std::shared_ptr<std::atomic<bool>> m_cancelToken;
+    // Flight this session leads; synthesised audio is published to its followers
+    std::shared_ptr<SingleFlight::Flight> m_flight;
+
+    // Speech being played, for its handle and for StopSpeak()
+    std::atomic<uint64_t> m_speechEpoch{0};
+    std::atomic<uint64_t> m_activeEpoch{0};
+    std::atomic<bool> m_speaking{false};
+    std::atomic<bool> m_audioPlayed{false};
+    std::mutex speechMutex;
+    SpeakHandle m_activeHandle;
+
+    std::mutex sessionMutex;  // guards stream_sid against Rebind()
+
+    // Telemetry
+    MetricsSeries m_metrics{[this] { return MetricsLabels(); }};
+    std::atomic<TTSCache::LabelCounters*> m_cacheCounters{nullptr};
+    std::chrono::steady_clock::time_point m_vendorRequestAt;
+    std::atomic<bool> m_awaitingFirstChunk{false};
+    std::atomic<int64_t> m_lastChunkAtNanos{0};  // steady clock; 0 at the start of each speech
 };
 
 #endif // TTSBASEMODULE_H
@@ -0,0 +1,173 @@
+#ifndef TTSSEGMENTSTORE_H
+#define TTSSEGMENTSTORE_H
+
+#include "CachedAudio.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+    Log-structured disk tier for TTSCache.
+
+    Audio is appended as records to large segment files (segment-000001.dat, ...)
+    instead of one file per phrase. An in-memory hash index maps each key to the
+    segment and offset of its latest record. On open, existing segments are
+    indexed from their record headers by a background thread while new records
+    go to a fresh segment; until the scan finishes, older keys read as misses.
+    A lock-free Bloom filter answers most misses before the index lock is
+    taken. Reads map the segment with mmap and return a view into the mapping,
+    so a hit never copies the audio.
+
+    Re-saving a key leaves the old record dead. A background thread compacts
+    sealed segments whose live fraction drops below half: live records are
+    re-appended to the active segment and the old file is deleted. Small
+    segments left by restarts are merged the same way.
+
+    With a disk budget set, the same thread evicts when the store grows past it
+    (or the volume runs low on space): the oldest sealed segment is rewritten
+    one at a time, keeping only entries hit recently (capped at half the
+    segment so every pass frees space) and dropping the rest from the index.
+    Hit counts and last access live in the index only, so after a restart the
+    first passes are plain oldest-first.
+
+    Record layout: RecordHeader | key bytes | payload. The CRC covers key and
+    payload and is checked for the last segment on open to drop a torn tail.
+
+    Each record carries a codec tag. Raw payloads are served straight from the
+    mapping; compressed payloads (uint32 raw length | deflate stream) are
+    inflated on read into a pooled buffer. With compression enabled a record is
+    only stored compressed when that saves at least 10%, so mixed segments are normal.
+*/
+class TTSSegmentStore {
+public:
+    enum class Codec : uint8_t { Raw = 0, Zlib = 1 };
+
+    struct CompressionStats {
+        uint64_t rawBytes = 0;          // audio bytes of records written compressed
+        uint64_t storedBytes = 0;       // their size on disk
+        uint64_t compressedEntries = 0;
+        uint64_t decodedHits = 0;
+        uint64_t decodeNanos = 0;
+
+        double ratio() const { return storedBytes ? static_cast<double>(rawBytes) / storedBytes : 1.0; }
+        double averageDecodeMicros() const { return decodedHits ? decodeNanos / 1000.0 / decodedHits : 0.0; }
+    };
+
+    struct EvictionStats {
+        uint64_t evictedEntries = 0;
+        uint64_t evictedBytes = 0;    // record bytes dropped from the index
+        uint64_t reclaimedBytes = 0;  // segment file bytes freed, including dead records
+        uint64_t passes = 0;          // segments rewritten by eviction
+        uint64_t reclaimNanos = 0;    // time spent in eviction passes
+    };
+
+    explicit TTSSegmentStore(const std::string& directory, uint64_t maxSegmentBytes = 256ull * 1024 * 1024);
+    ~TTSSegmentStore();
+
+    bool contains(const std::string& key);
+    CachedAudio read(const std::string& key);
+    bool append(const std::string& key, const uint8_t* data, size_t size);
+    // Flush appended records to stable storage (fdatasync of the segments written since the last sync)
+    bool sync();
+
+    // Rewrites sealed segments whose live fraction is below `minLiveRatio`; returns bytes reclaimed.
+    uint64_t compact(double minLiveRatio = 0.5);
+
+    // Codec for new records (default Raw); existing records keep theirs. Level is the zlib level.
+    void setCompression(Codec codec, int level = 1);
+    CompressionStats getCompressionStats() const;
+
+    // Bound on segment bytes on disk (0 = unbounded, the default). Eviction also runs when the
+    // volume has less than `minFreeBytes` available.
+    void setDiskBudget(uint64_t budgetBytes, uint64_t minFreeBytes = 1ull << 30);
+    uint64_t getDiskBudget() const;
+    EvictionStats getEvictionStats() const;
+
+    uint64_t totalBytes();
+    uint64_t liveBytes();
+    size_t entryCount();
+    // True once existing segments have been indexed
+    bool isIndexLoaded() const;
+
+private:
+    struct Location {
+        uint32_t segment;
+        uint64_t offset;  // of the audio bytes within the segment
+        uint32_t length;  // stored payload length
+        Codec codec;
+    };
+    struct IndexEntry {
+        Location location;
+        // Updated by readers under the shared lock
+        std::atomic<uint32_t> lastAccess{0};  // seconds since the store opened
+        std::atomic<uint32_t> hits{0};
+    };
+    struct Mapping;
+    struct Segment;
+    class BloomFilter;
+    class BufferPool;
+
+    std::shared_ptr<Segment> openSegment(uint32_t id, bool create);
+    void loadIndex();
+    void loadSegment(const std::shared_ptr<Segment>& segment, bool verifyChecksums);
+    std::shared_ptr<const Mapping> mappingFor(Segment& segment, uint64_t minLength);
+    bool appendRecord(const std::string& key, Codec codec, const uint8_t* payload, size_t size, const Location* expected);
+    CachedAudio decode(const std::shared_ptr<const Mapping>& mapping, const Location& location);
+    bool rewriteSegment(const std::shared_ptr<Segment>& victim, bool evict, uint64_t& copiedBytes);
+    bool overBudget();
+    void requestEviction();
+    void evictToBudget();
+    uint32_t secondsSinceOpen() const;
+    void removeLegacyFiles();
+    void maintenanceThread();
+
+    std::string m_directory;
+    std::atomic<uint64_t> m_maxSegmentBytes;
+    std::chrono::steady_clock::time_point m_openedAt = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> m_diskBudget{0};
+    std::atomic<uint64_t> m_minFreeBytes{0};
+    std::atomic<uint64_t> diskBytes{0};  // sum of segment sizes
+    std::atomic<Codec> m_codec{Codec::Raw};
+    std::atomic<int> m_compressionLevel{1};
+    std::unique_ptr<BloomFilter> bloom;
+    std::atomic<bool> indexLoaded{false};
+    std::shared_ptr<BufferPool> bufferPool;
+
+    std::atomic<uint64_t> compressedRawBytes{0};
+    std::atomic<uint64_t> compressedStoredBytes{0};
+    std::atomic<uint64_t> compressedEntries{0};
+    std::atomic<uint64_t> decodedHits{0};
+    std::atomic<uint64_t> decodeNanos{0};
+
+    std::atomic<uint64_t> evictedEntries{0};
+    std::atomic<uint64_t> evictedBytes{0};
+    std::atomic<uint64_t> reclaimedBytes{0};
+    std::atomic<uint64_t> evictionPasses{0};
+    std::atomic<uint64_t> reclaimNanos{0};
+
+    std::shared_mutex indexMutex;   // guards index, segments and liveBytes
+    std::unordered_map<std::string, IndexEntry> index;
+    std::map<uint32_t, std::shared_ptr<Segment>> segments;
+
+    std::mutex appendMutex;         // serialises writers and compaction
+    std::shared_ptr<Segment> activeSegment;
+    std::vector<std::shared_ptr<Segment>> unsyncedSegments;  // sealed since the last sync
+
+    bool stopMaintenance = false;
+    bool evictionRequested = false;
+    std::mutex maintenanceMutex;
+    std::condition_variable maintenanceCV;
+    std::thread maintenanceWorker;
+};
+
+#endif // TTSSEGMENTSTORE_H
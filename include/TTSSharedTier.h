@@ -0,0 +1,63 @@
+#ifndef TTSSHAREDTIER_H
+#define TTSSHAREDTIER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+    Host-wide TTSCache tier in a POSIX shared-memory arena (shm_open + mmap),
+    shared by every worker process that opens it under the same name.
+
+    The arena holds a fixed open-addressing index of 128-bit key digests and a
+    data ring. Lookups never lock: each index slot is a seqlock, read through a
+    read-only mapping, and a record is valid while the ring's write cursor has
+    not lapped it. A hit copies the audio out and re-checks the cursor, so a
+    record overwritten during the copy reads as a miss instead of torn audio.
+    Inserts from all processes are serialised by a robust process-shared mutex
+    in the arena header; a writer that dies holding it is recovered by the next.
+
+    The ring overwrites the oldest records once full, so capacity is the arena
+    size. The arena outlives the processes (it survives worker restarts) until
+    the name is shm_unlink'ed.
+*/
+class TTSSharedTier {
+public:
+    // Opens the arena `name` (e.g. "/voicekit-tts-cache"), creating it with `arenaBytes` if it does not
+    // exist; an existing arena keeps its size. Throws std::runtime_error if it cannot be mapped.
+    TTSSharedTier(const std::string& name, size_t arenaBytes);
+    ~TTSSharedTier();
+
+    TTSSharedTier(const TTSSharedTier&) = delete;
+    TTSSharedTier& operator=(const TTSSharedTier&) = delete;
+
+    // Copy of the audio for `key`, or nullptr on a miss
+    std::shared_ptr<const std::vector<uint8_t>> read(const std::string& key);
+    // Returns false when the audio is too large for the ring (over 1/8 of it)
+    bool insert(const std::string& key, const uint8_t* data, size_t size);
+
+    const std::string& name() const { return m_name; }
+    size_t arenaBytes() const { return m_arenaBytes; }
+    uint64_t insertCount() const;      // by all processes since the arena was created
+    uint64_t tornReads() const { return m_tornReads.load(); }  // hits lost to a concurrent overwrite
+
+private:
+    struct Header;
+    struct Slot;
+
+    void recoverAfterOwnerDeath();
+    Slot* slotFor(uint8_t* base, uint64_t index) const;
+
+    std::string m_name;
+    size_t m_arenaBytes = 0;
+    int m_fd = -1;
+    uint8_t* m_writable = nullptr;        // used by insert only
+    const uint8_t* m_readable = nullptr;  // PROT_READ view used by lookups
+    Header* m_header = nullptr;
+    std::atomic<uint64_t> m_tornReads{0};
+};
+
+#endif // TTSSHAREDTIER_H
@@ -0,0 +1,19 @@
+#ifndef VENDOR_ENDPOINTS_H
+#define VENDOR_ENDPOINTS_H
+
+#include <string>
+
+// Base URLs of the vendor services, without a trailing slash. Each one can be overridden
+// through the environment so local runs and load tests can point sessions at mock servers:
+//   VOICEKIT_DEEPGRAM_URL        wss://api.deepgram.com     listen and speak
+//   VOICEKIT_ELEVENLABS_URL      wss://api.elevenlabs.io    stream-input
+//   VOICEKIT_ELEVENLABS_API_URL  https://api.elevenlabs.io  voice lookup
+// The environment is read each time a session connects.
+class VendorEndpoints {
+public:
+    static std::string Deepgram();
+    static std::string ElevenlabsStream();
+    static std::string ElevenlabsApi();
+};
+
+#endif // VENDOR_ENDPOINTS_H
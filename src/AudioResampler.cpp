@@ -0,0 +1,231 @@
+#include "AudioResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RESAMPLER_SSE 1
+#endif
+
+/*
+    Polyphase layout: the prototype low-pass filter runs at inputRate * up and
+    is split into `up` phases of `taps` coefficients each. Every output sample
+    picks one phase and does a single dot product against the last `taps`
+    input samples, so the cost per output sample is `taps` MACs regardless of
+    how large `up` is. Coefficients are stored reversed per phase to keep the
+    dot product contiguous over the delay line.
+*/
+struct AudioResampler::Filter {
+    int up = 1;
+    int down = 1;
+    size_t taps = 0;     // coefficients per phase, multiple of 4
+    size_t delay = 0;    // group delay in input samples
+    size_t leadIn = 0;   // zeros primed into the delay line so output starts aligned
+    std::vector<float> coeffs;
+};
+
+namespace {
+
+constexpr double kZeroCrossings = 16.0;  // per side, at the narrower of the two bandwidths
+constexpr double kKaiserBeta = 8.0;
+constexpr double kRolloff = 0.92;        // cutoff as a fraction of the output Nyquist
+constexpr int kMaxFactor = 1000;
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; ++k) {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+std::shared_ptr<const AudioResampler::Filter> buildFilter(int up, int down) {
+    auto filter = std::make_shared<AudioResampler::Filter>();
+    filter->up = up;
+    filter->down = down;
+
+    double ratio = std::max(1.0, static_cast<double>(down) / up);
+    size_t taps = static_cast<size_t>(std::ceil(2.0 * kZeroCrossings * ratio));
+    taps = (taps + 3) & ~static_cast<size_t>(3);
+    filter->taps = taps;
+
+    // Center on a whole input sample so the group delay is an integral number of samples
+    size_t length = taps * up;
+    double cutoff = 0.5 * kRolloff / std::max(up, down);  // cycles per upsampled sample
+    double center = static_cast<double>((taps / 2) * up);
+    double norm = besselI0(kKaiserBeta);
+
+    std::vector<double> prototype(length, 0.0);
+    for (size_t i = 0; i < length; ++i) {
+        double x = i - center;
+        double r = x / center;
+        if (r * r >= 1.0) continue;
+        double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = besselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / norm;
+        prototype[i] = sinc * window;
+    }
+
+    filter->coeffs.resize(length);
+    for (int phase = 0; phase < up; ++phase) {
+        double sum = 0.0;
+        for (size_t k = 0; k < taps; ++k) sum += prototype[phase + k * up];
+        double gain = sum != 0.0 ? 1.0 / sum : 0.0;  // unity DC gain per phase
+
+        float* dst = &filter->coeffs[phase * taps];
+        for (size_t k = 0; k < taps; ++k) {
+            dst[taps - 1 - k] = static_cast<float>(prototype[phase + k * up] * gain);
+        }
+    }
+
+    filter->delay = taps / 2;
+    filter->leadIn = taps - 1 - filter->delay;
+    return filter;
+}
+
+// Filters are shared by every resampler with the same ratio.
+std::shared_ptr<const AudioResampler::Filter> cachedFilter(int up, int down) {
+    static std::mutex filterMutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const AudioResampler::Filter>> filters;
+
+    std::lock_guard<std::mutex> lock(filterMutex);
+    auto& entry = filters[{up, down}];
+    if (!entry) entry = buildFilter(up, down);
+    return entry;
+}
+
+inline float dotProduct(const float* a, const float* b, size_t n) {
+#ifdef RESAMPLER_SSE
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i < n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 0x55));
+    return _mm_cvtss_f32(acc0);
+#else
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+#endif
+}
+
+inline int16_t toSample(float value) {
+    long v = std::lrint(value);
+    return static_cast<int16_t>(std::clamp<long>(v, INT16_MIN, INT16_MAX));
+}
+
+std::vector<uint8_t> toBytes(const std::vector<int16_t>& samples) {
+    std::vector<uint8_t> bytes(samples.size() * 2);
+    for (size_t s = 0; s < samples.size(); ++s) {
+        bytes[2 * s] = static_cast<uint8_t>(samples[s] & 0xFF);
+        bytes[2 * s + 1] = static_cast<uint8_t>((samples[s] >> 8) & 0xFF);
+    }
+    return bytes;
+}
+
+} // namespace
+
+AudioResampler::AudioResampler(int inputRate, int outputRate)
+    : m_inputRate(inputRate), m_outputRate(outputRate) {
+    if (!isSupported(inputRate, outputRate)) {
+        throw std::invalid_argument("Unsupported resampling ratio " + std::to_string(inputRate) + " -> " + std::to_string(outputRate));
+    }
+    int g = std::gcd(inputRate, outputRate);
+    m_filter = cachedFilter(outputRate / g, inputRate / g);
+    reset();
+}
+
+bool AudioResampler::isSupported(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) return false;
+    int g = std::gcd(inputRate, outputRate);
+    return outputRate / g <= kMaxFactor && inputRate / g <= kMaxFactor;
+}
+
+void AudioResampler::reset() {
+    m_buffer.assign(m_filter->leadIn, 0.0f);
+    m_position = static_cast<uint64_t>(m_filter->taps - 1) * m_filter->up;
+    m_hasCarry = false;
+}
+
+void AudioResampler::run(std::vector<int16_t>& out) {
+    const Filter& f = *m_filter;
+
+    for (;;) {
+        size_t index = static_cast<size_t>(m_position / f.up);
+        if (index >= m_buffer.size()) break;
+        size_t phase = static_cast<size_t>(m_position % f.up);
+        const float* window = &m_buffer[index + 1 - f.taps];
+        out.push_back(toSample(dotProduct(&f.coeffs[phase * f.taps], window, f.taps)));
+        m_position += f.down;
+    }
+
+    // Keep only the delay line needed by the next output sample
+    size_t next = static_cast<size_t>(m_position / f.up);
+    size_t drop = std::min(next + 1 - f.taps, m_buffer.size());
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + drop);
+    m_position -= static_cast<uint64_t>(drop) * f.up;
+}
+
+void AudioResampler::process(const int16_t* samples, size_t count, std::vector<int16_t>& out) {
+    m_buffer.reserve(m_buffer.size() + count);
+    for (size_t i = 0; i < count; ++i) m_buffer.push_back(samples[i]);
+    out.reserve(out.size() + (count * m_filter->up) / m_filter->down + 1);
+    run(out);
+}
+
+std::vector<uint8_t> AudioResampler::process(const uint8_t* data, size_t size) {
+    std::vector<int16_t> samples;
+    samples.reserve(size / 2 + 1);
+
+    size_t i = 0;
+    if (m_hasCarry && size > 0) {
+        samples.push_back(static_cast<int16_t>(m_carry | (data[0] << 8)));
+        m_hasCarry = false;
+        i = 1;
+    }
+    for (; i + 1 < size; i += 2) {
+        samples.push_back(static_cast<int16_t>(data[i] | (data[i + 1] << 8)));
+    }
+    if (i < size) {
+        m_carry = data[i];
+        m_hasCarry = true;
+    }
+
+    std::vector<int16_t> resampled;
+    process(samples.data(), samples.size(), resampled);
+    return toBytes(resampled);
+}
+
+std::vector<uint8_t> AudioResampler::flush() {
+    std::vector<int16_t> silence(m_filter->delay, 0);
+    std::vector<int16_t> resampled;
+    process(silence.data(), silence.size(), resampled);
+    return toBytes(resampled);
+}
+
+std::vector<uint8_t> AudioResampler::convert(const std::vector<uint8_t>& pcm, int inputRate, int outputRate) {
+    if (inputRate == outputRate) return pcm;
+
+    AudioResampler resampler(inputRate, outputRate);
+    std::vector<uint8_t> out = resampler.process(pcm.data(), pcm.size());
+    std::vector<uint8_t> tail = resampler.flush();
+    out.insert(out.end(), tail.begin(), tail.end());
+    return out;
+}
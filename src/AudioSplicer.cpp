@@ -0,0 +1,54 @@
+#include "AudioSplicer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void AudioSplicer::trimSilence(const int16_t* samples, size_t count, int threshold, size_t keep,
+                               size_t& begin, size_t& end) {
+    size_t first = 0;
+    while (first < count && std::abs(samples[first]) <= threshold) ++first;
+    if (first == count) {
+        begin = end = 0;
+        return;
+    }
+    size_t last = count;
+    while (last > first && std::abs(samples[last - 1]) <= threshold) --last;
+    begin = first > keep ? first - keep : 0;
+    end = std::min(count, last + keep);
+}
+
+std::vector<uint8_t> AudioSplicer::splice(const std::vector<CachedAudio>& clips, const Options& options) {
+    size_t keep = static_cast<size_t>(options.pauseMs) * options.sampleRate / 1000;
+    size_t fade = static_cast<size_t>(options.crossfadeMs) * options.sampleRate / 1000;
+
+    size_t total = 0;
+    for (const auto& clip : clips) total += clip.size() / 2;
+    std::vector<int16_t> out;
+    out.reserve(total);
+
+    for (const auto& clip : clips) {
+        // Cached audio may sit at any offset in a mapping, so copy rather than cast
+        size_t count = clip.size() / 2;
+        std::vector<int16_t> samples(count);
+        if (count) std::memcpy(samples.data(), clip.data(), count * 2);
+
+        size_t begin, end;
+        trimSilence(samples.data(), count, options.silenceThreshold, keep, begin, end);
+        if (begin == end) continue;
+
+        // Overlap the head of this clip with the tail of what is already there
+        size_t overlap = std::min({fade, out.size(), end - begin});
+        size_t base = out.size() - overlap;
+        for (size_t i = 0; i < overlap; ++i) {
+            float in = static_cast<float>(i + 1) / (overlap + 1);
+            float mixed = out[base + i] * (1.0f - in) + samples[begin + i] * in;
+            out[base + i] = static_cast<int16_t>(std::clamp(mixed, -32768.0f, 32767.0f));
+        }
+        out.insert(out.end(), samples.begin() + begin + overlap, samples.begin() + end);
+    }
+
+    std::vector<uint8_t> pcm(out.size() * 2);
+    if (!out.empty()) std::memcpy(pcm.data(), out.data(), pcm.size());
+    return pcm;
+}
@@ -0,0 +1,133 @@
+#include "AzureSpeech.h"
+
+#include <spdlog/spdlog.h>
+
+AzureSpeech& AzureSpeech::getInstance() {
+    static AzureSpeech instance;
+    return instance;
+}
+
+std::string AzureSpeech::synthesisKey(const std::string& apiKey, const std::string& region,
+                                      const std::string& voiceName, SpeechSynthesisOutputFormat format) {
+    return "tts\n" + apiKey + "\n" + region + "\n" + voiceName + "\n" + std::to_string(static_cast<int>(format));
+}
+
+std::shared_ptr<SpeechConfig> AzureSpeech::synthesisConfig(const std::string& apiKey, const std::string& region,
+                                                           const std::string& voiceName,
+                                                           SpeechSynthesisOutputFormat format) {
+    std::string key = synthesisKey(apiKey, region, voiceName, format);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& config = configs[key];
+    if (!config) {
+        config = SpeechConfig::FromSubscription(apiKey, region);
+        config->SetSpeechSynthesisVoiceName(voiceName);
+        config->SetSpeechSynthesisOutputFormat(format);
+    }
+    return config;
+}
+
+std::shared_ptr<SpeechConfig> AzureSpeech::recognitionConfig(const std::string& apiKey, const std::string& region,
+                                                             const std::string& language) {
+    std::string key = "stt\n" + apiKey + "\n" + region + "\n" + language;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& config = configs[key];
+    if (!config) {
+        config = SpeechConfig::FromSubscription(apiKey, region);
+        config->SetProperty(PropertyId::SpeechServiceConnection_InitialSilenceTimeoutMs, "10000");
+        config->SetProperty(PropertyId::SpeechServiceConnection_EndSilenceTimeoutMs, "1000");
+        config->SetProperty(PropertyId::Speech_SegmentationSilenceTimeoutMs, "3000");
+        // Recognizers copy the config when created, so the language has to be set before that
+        config->SetSpeechRecognitionLanguage(language);
+    }
+    return config;
+}
+
+AzureSpeech::PooledSynthesizer AzureSpeech::createSynthesizer(const std::string& apiKey, const std::string& region,
+                                                             const std::string& voiceName,
+                                                             SpeechSynthesisOutputFormat format) {
+    PooledSynthesizer pooled;
+    pooled.synthesizer = SpeechSynthesizer::FromConfig(synthesisConfig(apiKey, region, voiceName, format));
+    pooled.connection = Connection::FromSynthesizer(pooled.synthesizer);
+    pooled.key = synthesisKey(apiKey, region, voiceName, format);
+    return pooled;
+}
+
+std::shared_ptr<SpeechSynthesizer> AzureSpeech::acquireSynthesizer(const std::string& apiKey,
+                                                                   const std::string& region,
+                                                                   const std::string& voiceName,
+                                                                   SpeechSynthesisOutputFormat format) {
+    std::string key = synthesisKey(apiKey, region, voiceName, format);
+    PooledSynthesizer pooled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = idle.find(key);
+        if (it != idle.end() && !it->second.empty()) {
+            pooled = std::move(it->second.front());
+            it->second.pop_front();
+        }
+    }
+    if (!pooled.synthesizer) pooled = createSynthesizer(apiKey, region, voiceName, format);
+
+    // Open() returns at once; a connection the service closed while idle is re-established
+    // in the background instead of on the first SpeakTextAsync
+    pooled.connection->Open(false);
+
+    std::shared_ptr<SpeechSynthesizer> synthesizer = pooled.synthesizer;
+    std::lock_guard<std::mutex> lock(mutex);
+    leased[synthesizer.get()] = std::move(pooled);
+    return synthesizer;
+}
+
+void AzureSpeech::releaseSynthesizer(const std::shared_ptr<SpeechSynthesizer>& synthesizer, bool reusable) {
+    if (!synthesizer) return;
+    synthesizer->Synthesizing.DisconnectAll();
+    synthesizer->SynthesisStarted.DisconnectAll();
+    synthesizer->SynthesisCompleted.DisconnectAll();
+    synthesizer->SynthesisCanceled.DisconnectAll();
+
+    PooledSynthesizer pooled;  // destroyed outside the lock when not kept
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = leased.find(synthesizer.get());
+    if (it == leased.end()) return;
+    pooled = std::move(it->second);
+    leased.erase(it);
+
+    auto& queue = idle[pooled.key];
+    if (reusable && queue.size() < maxIdle) {
+        queue.push_back(std::move(pooled));
+    } else if (!reusable) {
+        SPDLOG_INFO("Discarding Azure synthesizer after a synthesis error");
+    }
+}
+
+void AzureSpeech::prewarmSynthesizers(const std::string& apiKey, const std::string& region,
+                                      const std::string& voiceName, SpeechSynthesisOutputFormat format,
+                                      size_t count) {
+    std::string key = synthesisKey(apiKey, region, voiceName, format);
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (idle[key].size() >= std::min(count, maxIdle)) return;
+        }
+        PooledSynthesizer pooled = createSynthesizer(apiKey, region, voiceName, format);
+        pooled.connection->Open(false);
+        std::lock_guard<std::mutex> lock(mutex);
+        idle[key].push_back(std::move(pooled));
+    }
+}
+
+void AzureSpeech::openConnection(const std::shared_ptr<SpeechRecognizer>& recognizer) {
+    if (recognizer) Connection::FromRecognizer(recognizer)->Open(true);
+}
+
+void AzureSpeech::setMaxIdleSynthesizers(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxIdle = count;
+}
+
+size_t AzureSpeech::idleSynthesizers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& entry : idle) total += entry.second.size();
+    return total;
+}
@@ -0,0 +1,258 @@
+#include "Base64Decoder.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BASE64_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint8_t kInvalid = 0xFF;
+
+struct DecodeTable {
+    uint8_t values[256];
+
+    constexpr DecodeTable() : values() {
+        for (int i = 0; i < 256; ++i) values[i] = kInvalid;
+        for (int i = 0; i < 26; ++i) {
+            values['A' + i] = static_cast<uint8_t>(i);
+            values['a' + i] = static_cast<uint8_t>(26 + i);
+        }
+        for (int i = 0; i < 10; ++i) values['0' + i] = static_cast<uint8_t>(52 + i);
+        values['+'] = 62;
+        values['/'] = 63;
+    }
+};
+
+constexpr DecodeTable kTable;
+
+// Drops up to two trailing '=' and rejects lengths that cannot be valid base64.
+bool trimPadding(const char* input, size_t& length) {
+    size_t padding = 0;
+    while (length > 0 && padding < 2 && input[length - 1] == '=') {
+        --length;
+        ++padding;
+    }
+    if (padding && (length + padding) % 4 != 0) return false;
+    return length % 4 != 1;
+}
+
+// Decodes `length` unpadded characters one quad at a time using the lookup table.
+ptrdiff_t decodeScalar(const uint8_t* in, size_t length, uint8_t* out) {
+    uint8_t* start = out;
+    size_t i = 0;
+
+    for (; i + 4 <= length; i += 4) {
+        uint32_t a = kTable.values[in[i]];
+        uint32_t b = kTable.values[in[i + 1]];
+        uint32_t c = kTable.values[in[i + 2]];
+        uint32_t d = kTable.values[in[i + 3]];
+        if ((a | b | c | d) & 0x80) return -1;
+
+        uint32_t triple = (a << 18) | (b << 12) | (c << 6) | d;
+        out[0] = static_cast<uint8_t>(triple >> 16);
+        out[1] = static_cast<uint8_t>(triple >> 8);
+        out[2] = static_cast<uint8_t>(triple);
+        out += 3;
+    }
+
+    size_t rest = length - i;
+    if (rest >= 2) {
+        uint32_t a = kTable.values[in[i]];
+        uint32_t b = kTable.values[in[i + 1]];
+        uint32_t c = rest == 3 ? kTable.values[in[i + 2]] : 0;
+        if ((a | b | c) & 0x80) return -1;
+
+        uint32_t triple = (a << 18) | (b << 12) | (c << 6);
+        *out++ = static_cast<uint8_t>(triple >> 16);
+        if (rest == 3) *out++ = static_cast<uint8_t>(triple >> 8);
+    }
+
+    return out - start;
+}
+
+#ifdef BASE64_X86_KERNELS
+
+/*
+    Vector kernels follow the nibble-lookup scheme from Muła/Klomp/Lemire:
+    two pshufb lookups on the high and low nibble classify each character,
+    a third lookup yields the delta that maps ASCII to its 6-bit value, and
+    maddubs/madd pack four 6-bit values into three bytes.
+
+    Each iteration stores a full register but only advances by 12 (SSE) or
+    24 (AVX2) bytes, so the loops stop early enough that the trailing input
+    always decodes over the spilled bytes. Any block holding a non-alphabet
+    character is left to the scalar path, which reports the error.
+*/
+
+__attribute__((target("sse4.1")))
+size_t decodeSSE41(const uint8_t* in, size_t length, uint8_t*& out) {
+    const __m128i lutLo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2F);
+    const __m128i packPairs = _mm_set1_epi32(0x01400140);
+    const __m128i packQuads = _mm_set1_epi32(0x00011000);
+    const __m128i reorder = _mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    while (length - i >= 24) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+        const __m128i loNibbles = _mm_and_si128(str, mask2F);
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm_testz_si128(lo, hi)) break;
+
+        const __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        str = _mm_add_epi8(str, roll);
+
+        str = _mm_maddubs_epi16(str, packPairs);
+        str = _mm_madd_epi16(str, packQuads);
+        str = _mm_shuffle_epi8(str, reorder);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), str);
+        out += 12;
+        i += 16;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t decodeAVX2(const uint8_t* in, size_t length, uint8_t*& out) {
+    const __m256i lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71,
+        0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2F);
+    const __m256i packPairs = _mm256_set1_epi32(0x01400140);
+    const __m256i packQuads = _mm256_set1_epi32(0x00011000);
+    const __m256i reorder = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i joinLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    size_t i = 0;
+    while (length - i >= 48) {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+        const __m256i loNibbles = _mm256_and_si256(str, mask2F);
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm256_testz_si256(lo, hi)) break;
+
+        const __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        str = _mm256_maddubs_epi16(str, packPairs);
+        str = _mm256_madd_epi16(str, packQuads);
+        str = _mm256_shuffle_epi8(str, reorder);
+        str = _mm256_permutevar8x32_epi32(str, joinLanes);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), str);
+        out += 24;
+        i += 32;
+    }
+    return i;
+}
+
+#endif // BASE64_X86_KERNELS
+
+} // namespace
+
+size_t Base64Decoder::maxDecodedSize(size_t length) {
+    return (length / 4) * 3 + (length % 4);
+}
+
+ptrdiff_t Base64Decoder::decode(const char* input, size_t length, uint8_t* output) {
+    return decode(input, length, output, bestKernel());
+}
+
+ptrdiff_t Base64Decoder::decode(const char* input, size_t length, uint8_t* output, Kernel kernel) {
+    if (!trimPadding(input, length)) return -1;
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+    uint8_t* out = output;
+    size_t consumed = 0;
+
+#ifdef BASE64_X86_KERNELS
+    if (kernel == Kernel::AVX2 && isSupported(Kernel::AVX2)) {
+        consumed = decodeAVX2(in, length, out);
+    }
+    if (kernel != Kernel::Scalar && isSupported(Kernel::SSE41)) {
+        consumed += decodeSSE41(in + consumed, length - consumed, out);
+    }
+#endif
+
+    ptrdiff_t tail = decodeScalar(in + consumed, length - consumed, out);
+    if (tail < 0) return -1;
+    return (out - output) + tail;
+}
+
+bool Base64Decoder::decodeAppend(const std::string& input, std::vector<uint8_t>& output) {
+    size_t offset = output.size();
+    output.resize(offset + maxDecodedSize(input.size()));
+
+    ptrdiff_t written = decode(input.data(), input.size(), output.data() + offset);
+    if (written < 0) {
+        output.resize(offset);
+        return false;
+    }
+    output.resize(offset + static_cast<size_t>(written));
+    return true;
+}
+
+Base64Decoder::Kernel Base64Decoder::bestKernel() {
+    static const Kernel kernel = isSupported(Kernel::AVX2) ? Kernel::AVX2
+                               : isSupported(Kernel::SSE41) ? Kernel::SSE41
+                               : Kernel::Scalar;
+    return kernel;
+}
+
+bool Base64Decoder::isSupported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#ifdef BASE64_X86_KERNELS
+    case Kernel::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* Base64Decoder::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::SSE41:
+        return "sse4.1";
+    case Kernel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,186 @@
+#include "BulkTranscriber.h"
+#include "STTFactory.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr int kFrameMs = 20;
+
+uint32_t readLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+uint16_t readLE16(const uint8_t* p) {
+    return uint16_t(p[0] | p[1] << 8);
+}
+
+// Replaces a RIFF/WAVE file's bytes with its PCM data and returns its sample rate; 0 if not a WAV file
+int unwrapWav(std::vector<uint8_t>& bytes) {
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return 0;
+    }
+    int sampleRate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const uint8_t* chunk = bytes.data() + pos;
+        size_t size = readLE32(chunk + 4);
+        size_t body = pos + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && body + 16 <= bytes.size()) {
+            uint16_t format = readLE16(bytes.data() + body);
+            uint16_t channels = readLE16(bytes.data() + body + 2);
+            uint16_t bits = readLE16(bytes.data() + body + 14);
+            if (format != 1 || channels != 1 || bits != 16) {
+                throw std::runtime_error("Bulk transcription needs 16-bit mono PCM WAV files");
+            }
+            sampleRate = static_cast<int>(readLE32(bytes.data() + body + 4));
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (sampleRate == 0) throw std::runtime_error("WAV data chunk before its fmt chunk");
+            size_t end = std::min(bytes.size(), body + size);
+            bytes = std::vector<uint8_t>(bytes.begin() + body, bytes.begin() + end);
+            return sampleRate;
+        }
+        pos = body + size + (size & 1);
+    }
+    throw std::runtime_error("WAV file without a data chunk");
+}
+
+} // namespace
+
+BulkTranscriber::BulkTranscriber(const Options& options) : m_options(options) {
+    if (m_options.parallel == 0) m_options.parallel = 1;
+}
+
+std::vector<size_t> BulkTranscriber::SplitPoints(const std::vector<uint8_t>& pcm, int sampleRate, const Options& options) {
+    size_t frameBytes = static_cast<size_t>(sampleRate) * kFrameMs / 1000 * 2;
+    size_t frames = frameBytes ? pcm.size() / frameBytes : 0;
+    size_t chunkFrames = static_cast<size_t>(std::max(1, options.chunkSeconds)) * 1000 / kFrameMs;
+    size_t searchFrames = static_cast<size_t>(std::max(0, options.searchSeconds)) * 1000 / kFrameMs;
+    size_t minSilentFrames = std::max(1, options.minSilenceMs / kFrameMs);
+
+    std::vector<double> levels(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        std::vector<int16_t> samples(frameBytes / 2);
+        std::memcpy(samples.data(), pcm.data() + i * frameBytes, frameBytes);
+        levels[i] = EnergyVAD::levelDb(samples.data(), samples.size());
+    }
+
+    std::vector<size_t> points{0};
+    size_t start = 0;
+    while (frames - start > chunkFrames + searchFrames) {
+        size_t target = start + chunkFrames;
+        size_t from = target - std::min(target - start - 1, searchFrames);
+        size_t to = std::min(frames, target + searchFrames);
+
+        // Middle of the silent run closest to the target that is long enough; failing that, the
+        // quietest frame in reach
+        auto distance = [target](size_t frame) { return frame > target ? frame - target : target - frame; };
+        size_t quietest = from;
+        for (size_t i = from; i < to; ++i) {
+            if (levels[i] < levels[quietest]) quietest = i;
+        }
+        size_t best = quietest;
+        bool found = false;
+        for (size_t i = from; i < to;) {
+            if (levels[i] >= options.silenceDb) {
+                ++i;
+                continue;
+            }
+            size_t runStart = i;
+            while (i < to && levels[i] < options.silenceDb) ++i;
+            size_t middle = runStart + (i - runStart) / 2;
+            if (i - runStart >= minSilentFrames && (!found || distance(middle) < distance(best))) {
+                best = middle;
+                found = true;
+            }
+        }
+        size_t split = best;
+        if (split <= start) split = target;
+        points.push_back(split * frameBytes);
+        start = split;
+    }
+    return points;
+}
+
+BulkTranscriber::Result BulkTranscriber::TranscribeFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open " + path);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    int sampleRate = unwrapWav(bytes);
+    if (sampleRate > 0 && sampleRate != m_options.config.sampleRate) {
+        BulkTranscriber withRate(m_options);
+        withRate.m_options.config.sampleRate = sampleRate;
+        return withRate.Transcribe(bytes);
+    }
+    return Transcribe(bytes);
+}
+
+BulkTranscriber::Result BulkTranscriber::Transcribe(const std::vector<uint8_t>& pcm) {
+    const int sampleRate = m_options.config.sampleRate;
+    if (sampleRate <= 0) throw std::invalid_argument("Invalid STT sample rate " + std::to_string(sampleRate));
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<size_t> points = SplitPoints(pcm, sampleRate, m_options);
+    points.push_back(pcm.size());
+    size_t pieces = points.size() - 1;
+
+    Result result;
+    result.pieces = pieces;
+    result.audioMs = 1000.0 * (pcm.size() / 2) / sampleRate;
+
+    std::vector<std::vector<TranscriptSegment>> transcripts(pieces);
+    std::mutex errorsMutex;
+    std::atomic<size_t> next{0};
+    auto worker = [&](size_t workerIndex) {
+        for (size_t piece = next++; piece < pieces; piece = next++) {
+            size_t begin = points[piece] & ~size_t(1);
+            size_t end = std::min(points[piece + 1], pcm.size()) & ~size_t(1);
+            double offsetMs = 1000.0 * (begin / 2) / sampleRate;
+            std::string sid = "bulk-" + std::to_string(workerIndex) + "-" + std::to_string(piece);
+            try {
+                auto module = std::dynamic_pointer_cast<STTModuleBase>(STTFactory::CreateSTTModule(
+                    m_options.provider, sid, [](std::string&) {}, m_options.config.language));
+                if (!module) throw std::runtime_error("STT provider " + m_options.provider + " has no bulk mode");
+                module->Configure(m_options.config);
+                module->InitialiseSTTModule(m_options.config.apiKey, m_options.config.region);
+                auto segments = module->TranscribeAudio(pcm.data() + begin, end - begin, m_options.stream);
+                for (auto& segment : segments) {
+                    segment.startMs += offsetMs;
+                    segment.endMs += offsetMs;
+                }
+                transcripts[piece] = std::move(segments);
+            } catch (const std::exception& e) {
+                SPDLOG_ERROR("[{}] Bulk piece at {:.1f} s failed: {}", sid, offsetMs / 1000, e.what());
+                std::lock_guard<std::mutex> lock(errorsMutex);
+                result.errors.push_back("piece at " + std::to_string(static_cast<int>(offsetMs / 1000)) + " s: " + e.what());
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(m_options.parallel, pieces); ++i) workers.emplace_back(worker, i);
+    for (auto& thread : workers) thread.join();
+
+    for (auto& segments : transcripts) {
+        for (auto& segment : segments) {
+            if (!result.text.empty()) result.text += ' ';
+            result.text += segment.text;
+            result.segments.push_back(std::move(segment));
+        }
+    }
+    result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    SPDLOG_INFO("Bulk transcription: {:.1f} s of audio in {} pieces took {:.1f} s ({:.1f}x real time), {} failed",
+                result.audioMs / 1000, pieces, result.elapsedMs / 1000,
+                result.elapsedMs > 0 ? result.audioMs / result.elapsedMs : 0.0, result.errors.size());
+    return result;
+}
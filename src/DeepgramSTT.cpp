@@ -1,31 +1,42 @@
 #include "DeepgramSTT.h"
+#include "VendorEndpoints.h"
 #include <spdlog/spdlog.h>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 
 void DeepgramSTT::InitialiseSTTModule(const std::string& apiKey, const std::string& region) {
     this->apiKey = apiKey;
 }
 
 void DeepgramSTT::ImplStartRecognition() {
+    connect(false);
+}
+
+void DeepgramSTT::connect(bool bulk) {
     std::string model = "nova-3";
     std::string encoding = "linear16";
-    int sample_rate = 8000;
+    int sample_rate = m_inputSampleRate; // Deepgram takes linear16 at any rate, no conversion needed
+    m_vendorSampleRate = sample_rate;
     int channels = 1;
     int endpointing_ms = 500;
     int utterance_end_ms = 2000;
     bool smart_format = true;
 
     std::ostringstream urlStream;
-    urlStream << "wss://api.deepgram.com/v1/listen"
+    urlStream << VendorEndpoints::Deepgram() << "/v1/listen"
               << "?model=" << model
               << "&language=" << language
               << "&punctuate=true"
-              << "&interim_results=true"
-              << "&vad_events=true"
-              << "&smart_format=" << (smart_format ? "true" : "false")
-              << "&utterance_end_ms=" << utterance_end_ms
-              << "&endpointing=" << endpointing_ms
-              << "&encoding=" << encoding
+              << "&interim_results=" << (bulk ? "false" : "true")
+              << "&vad_events=" << (bulk ? "false" : "true")
+              << "&smart_format=" << (smart_format ? "true" : "false");
+    if (!bulk) {
+        // Both need interim results; bulk runs rely on CloseStream to flush the last transcript
+        urlStream << "&utterance_end_ms=" << utterance_end_ms
+                  << "&endpointing=" << endpointing_ms;
+    }
+    urlStream << "&encoding=" << encoding
               << "&sample_rate=" << sample_rate
               << "&channels=" << channels;
     
@@ -35,16 +46,36 @@ void DeepgramSTT::ImplStartRecognition() {
     ix::WebSocketHttpHeaders headers;
     headers["Authorization"] = "token " + apiKey;
     webSocket.setExtraHeaders(headers);
+    if (bulk) {
+        webSocket.disableAutomaticReconnection();
+    } else {
+        webSocket.enableAutomaticReconnection();
+    }
+    {
+        std::lock_guard<std::mutex> lock(wsMutex);
+        socketClosed = false;
+        socketError.clear();
+    }
 
     webSocket.setOnMessageCallback([this](const ix::WebSocketMessagePtr& msg) {
         if (msg->type == ix::WebSocketMessageType::Message) {
             handleMessage(msg->str);
         } else if (msg->type == ix::WebSocketMessageType::Open) {
-            SPDLOG_INFO("[{}] Deepgram connection opened", stream_sid);
+            SPDLOG_INFO("[{}] Deepgram connection opened", SessionId());
             std::lock_guard<std::mutex> lock(wsMutex);
             isConnected = true;
+            wsCV.notify_all();
+        } else if (msg->type == ix::WebSocketMessageType::Close) {
+            // After CloseStream, Deepgram sends the remaining results and then closes
+            std::lock_guard<std::mutex> lock(wsMutex);
+            isConnected = false;
+            socketClosed = true;
+            wsCV.notify_all();
         } else if (msg->type == ix::WebSocketMessageType::Error) {
-            SPDLOG_ERROR("[{}] WebSocket Error: {}", stream_sid, msg->errorInfo.reason);
+            SPDLOG_ERROR("[{}] WebSocket Error: {}", SessionId(), msg->errorInfo.reason);
+            std::lock_guard<std::mutex> lock(wsMutex);
+            socketError = msg->errorInfo.reason;
+            wsCV.notify_all();
         }
     });
 
@@ -60,12 +91,62 @@ void DeepgramSTT::ImplStreamAudioData(std::vector<uint8_t> audioData) {
 }
 
 void DeepgramSTT::ImplStopRecognition() {
-    std::lock_guard<std::mutex> lock(wsMutex);
-    if (isConnected) {
+    {
+        std::lock_guard<std::mutex> lock(wsMutex);
+        if (!isConnected) return;
         webSocket.sendText("{\"type\": \"CloseStream\"}");
+        isConnected = false;
+    }
+    // stop() joins the socket thread, whose callbacks take wsMutex
+    webSocket.stop();
+}
+
+void DeepgramSTT::ImplBeginBulk() {
+    connect(true);
+    std::unique_lock<std::mutex> lock(wsMutex);
+    bool ready = wsCV.wait_for(lock, m_bulkOptions.readyTimeout,
+                               [this] { return isConnected || socketClosed || !socketError.empty(); });
+    if (!isConnected) {
+        std::string reason = !ready ? "timed out" : socketError.empty() ? "closed" : socketError;
+        lock.unlock();
         webSocket.stop();
+        throw std::runtime_error("Deepgram bulk connection failed: " + reason);
+    }
+}
+
+void DeepgramSTT::ImplStreamBulk(const uint8_t* audioData, size_t size) {
+    // Flow control: let the socket drain before queueing more
+    while (webSocket.bufferedAmount() > m_bulkOptions.maxBufferedBytes) {
+        {
+            std::lock_guard<std::mutex> lock(wsMutex);
+            if (!isConnected) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    std::lock_guard<std::mutex> lock(wsMutex);
+    if (!isConnected) {
+        throw std::runtime_error("Deepgram closed the bulk connection" + (socketError.empty() ? "" : ": " + socketError));
+    }
+    webSocket.sendBinary(std::string(reinterpret_cast<const char*>(audioData), size));
+}
+
+void DeepgramSTT::ImplEndBulk() {
+    std::unique_lock<std::mutex> lock(wsMutex);
+    if (isConnected) webSocket.sendText("{\"type\": \"CloseStream\"}");
+    bool finished = wsCV.wait_for(lock, m_bulkOptions.finishTimeout, [this] { return socketClosed; });
+    isConnected = false;
+    lock.unlock();
+    webSocket.stop();
+    if (!finished) throw std::runtime_error("Timed out waiting for Deepgram to finish the bulk transcript");
+}
+
+void DeepgramSTT::ImplAbortBulk() {
+    {
+        std::lock_guard<std::mutex> lock(wsMutex);
         isConnected = false;
     }
+    // stop() joins the socket thread, whose callbacks take wsMutex
+    webSocket.stop();
 }
 
 void DeepgramSTT::ImplRecognize() {
@@ -78,13 +159,14 @@ void DeepgramSTT::handleMessage(const std::string& message) {
 
     // Handle SpeechStarted event
     if (parsed.contains("type") && parsed["type"] == "SpeechStarted") {
-        SPDLOG_INFO("[{}] 🎤 Speech started at {:.2f}s", stream_sid, parsed.value("timestamp", 0.0));
+        VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] 🎤 Speech started at {:.2f}s", SessionId(), parsed.value("timestamp", 0.0));
+        RecognitionEvent(STTEventType::SpeechStarted);
         return;
     }
 
     // Handle UtteranceEnd event
     if (parsed.contains("type") && parsed["type"] == "UtteranceEnd") {
-        SPDLOG_INFO("[{}] 🛑 Utterance ended. Last word ended at {:.2f}s", stream_sid, parsed.value("last_word_end", 0.0));
+        VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] 🛑 Utterance ended. Last word ended at {:.2f}s", SessionId(), parsed.value("last_word_end", 0.0));
         return;
     }
 
@@ -100,14 +182,17 @@ void DeepgramSTT::handleMessage(const std::string& message) {
 
         if (!transcript.empty()) {
             if (isFinal) {
-                SPDLOG_INFO("[{}] ✅ FINAL: {}", stream_sid, transcript);
-                RecognisedText(transcript); // user-defined callback
+                VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] ✅ FINAL ({} chars)", SessionId(), transcript.size());
+                SPDLOG_DEBUG("[{}] FINAL: {}", SessionId(), transcript);
+                double startMs = parsed.value("start", 0.0) * 1000;
+                double endMs = startMs + parsed.value("duration", 0.0) * 1000;
+                RecognisedSegment(transcript, startMs, endMs); // user-defined callback
             } else {
-                SPDLOG_INFO("[{}] 🟡 INTERIM: {}", stream_sid, transcript);
+                VOICEKIT_LOG_FRAME("[{}] 🟡 INTERIM: {}", SessionId(), transcript);
             }
 
             if (speechFinal) {
-                SPDLOG_INFO("[{}] 📌 Speech endpointing triggered", stream_sid);
+                VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] 📌 Speech endpointing triggered", SessionId());
             }
         }
     }
@@ -1,18 +1,28 @@
 #include "DeepgramTTS.h"
+#include "VendorEndpoints.h"
 #include <spdlog/spdlog.h>
 #include <chrono>
 #include <thread>
 
 bool DeepgramTTS::Initialise(const std::string& apiKey, const std::string& region) {
     m_apiKey = apiKey;
+    // linear16 is offered at these rates; request the playout rate directly when we can
+    switch (m_outputSampleRate) {
+    case 8000: case 16000: case 24000: case 32000: case 48000:
+        m_vendorSampleRate = m_outputSampleRate;
+        break;
+    default:
+        m_vendorSampleRate = 16000;
+        break;
+    }
     StartWebSocket();
     return true;
 }
 
 std::string DeepgramTTS::buildWebSocketURL() const {
-    std::string url = "wss://api.deepgram.com/v1/speak?";
+    std::string url = VendorEndpoints::Deepgram() + "/v1/speak?";
     url += "model=" + m_voiceName;
-    url += "&encoding=linear16&sample_rate=8000";
+    url += "&encoding=linear16&sample_rate=" + std::to_string(m_vendorSampleRate);
     return url;
 }
 
@@ -28,14 +38,14 @@ void DeepgramTTS::StartWebSocket() {
         if (msg->type == ix::WebSocketMessageType::Message) {
             handleMessage(msg->str);
         } else if (msg->type == ix::WebSocketMessageType::Open) {
-            SPDLOG_INFO("[{}] Deepgram connection opened", stream_sid);
+            SPDLOG_INFO("[{}] Deepgram connection opened", SessionId());
             {
                 std::lock_guard<std::mutex> lock(wsMutex);
                 isConnected.store(true);
             }
             wsCv.notify_all();  // Notify the waiting thread that the connection is established
         } else if (msg->type == ix::WebSocketMessageType::Error) {
-            SPDLOG_ERROR("[{}] WebSocket Error: {}", stream_sid, msg->errorInfo.reason);
+            SPDLOG_ERROR("[{}] WebSocket Error: {}", SessionId(), msg->errorInfo.reason);
             isConnected.store(false);
         }
     });
@@ -45,7 +55,7 @@ void DeepgramTTS::StartWebSocket() {
 
 void DeepgramTTS::handleMessage(const std::string& message) {
     if (message.rfind("{", 0) == 0) {
-        SPDLOG_DEBUG("[{}] Text Response: {}", stream_sid, message);
+        SPDLOG_DEBUG("[{}] Text Response: {}", SessionId(), message);
 
         try {
             auto jsonMsg = nlohmann::json::parse(message);
@@ -53,16 +63,23 @@ void DeepgramTTS::handleMessage(const std::string& message) {
                 std::string type = jsonMsg["type"];
 
                 if (type == "Flushed") {
-                    SPDLOG_INFO("[{}] Received Flushed message", stream_sid);
+                    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Received Flushed message", SessionId());
                     {
                         std::lock_guard<std::mutex> lock(flushedMutex);
+                        if (m_clearing) return;  // the cancelled request's
                         isFlushedReceived.store(true);
                     }
                     flushedCv.notify_all();
+                } else if (type == "Cleared") {
+                    {
+                        std::lock_guard<std::mutex> lock(flushedMutex);
+                        m_clearing = false;
+                    }
+                    flushedCv.notify_all();
                 }
             }
         } catch (const std::exception& e) {
-            SPDLOG_WARN("[{}] Failed to parse JSON message: {}", stream_sid, e.what());
+            SPDLOG_WARN("[{}] Failed to parse JSON message: {}", SessionId(), e.what());
         }
 
         return;
@@ -70,17 +87,23 @@ void DeepgramTTS::handleMessage(const std::string& message) {
 
     // Handle binary audio data
     std::vector<uint8_t> audioChunk(message.begin(), message.end());
-    SPDLOG_INFO("[{}] Received audio chunk of size {}", stream_sid, audioChunk.size());
+    VOICEKIT_LOG_FRAME("[{}] Received audio chunk of size {}", SessionId(), audioChunk.size());
 
+    {
+        std::lock_guard<std::mutex> lock(flushedMutex);
+        if (m_clearing) return;  // audio of a cancelled request, still in flight when Clear was sent
+    }
     {
         std::lock_guard<std::mutex> lock(accumulatedAudioMutex);
         accumulatedAudioBuffer.insert(accumulatedAudioBuffer.end(), audioChunk.begin(), audioChunk.end());
     }
+    AudioChunkReceived();
 }
 
 void DeepgramTTS::ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) {
     std::unique_lock<std::mutex> ttsLock(ttsProcessingMutex);
-    SPDLOG_INFO("[{}] Starting synthesis for text: {}", stream_sid, text);
+    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Starting synthesis ({} chars)", stream_sid, text.size());
+    SPDLOG_DEBUG("[{}] Synthesis text: {}", stream_sid, text);
 
     {
         std::unique_lock<std::mutex> lock(wsMutex);
@@ -92,6 +115,23 @@ void DeepgramTTS::ImplSynthesiseVoice(const std::string& text, const std::string
         }
     }
 
+    // Messages arrive in order, so once the last Clear is confirmed nothing older can follow
+    bool cleared;
+    {
+        std::unique_lock<std::mutex> lock(flushedMutex);
+        cleared = flushedCv.wait_for(lock, std::chrono::seconds(2), [this] { return !m_clearing; });
+        m_clearing = false;
+    }
+    if (!cleared) {
+        SPDLOG_WARN("[{}] No Cleared from Deepgram; reconnecting", stream_sid);
+        Reconnect();
+        std::unique_lock<std::mutex> lock(wsMutex);
+        if (!wsCv.wait_for(lock, std::chrono::seconds(5), [this] { return isConnected.load(); })) {
+            SPDLOG_ERROR("[{}] TTS WebSocket connection timeout!", stream_sid);
+            return;
+        }
+    }
+
     {
         std::lock_guard<std::mutex> lock(accumulatedAudioMutex);
         accumulatedAudioBuffer.clear();
@@ -101,6 +141,10 @@ void DeepgramTTS::ImplSynthesiseVoice(const std::string& text, const std::string
     m_startTime = std::chrono::high_resolution_clock::now();
     m_currentHashKey = hashKey;
 
+    if (IsSynthesisCancelled()) {
+        return;
+    }
+
     {
         std::lock_guard<std::mutex> sendLock(sendMutex);
         nlohmann::json speakMsg = {{"type", "Speak"}, {"text", text}};
@@ -113,12 +157,17 @@ void DeepgramTTS::ImplSynthesiseVoice(const std::string& text, const std::string
     // Wait for "Flushed" message
     {
         std::unique_lock<std::mutex> lock(flushedMutex);
-        if (!flushedCv.wait_for(lock, std::chrono::seconds(30), [this] { return isFlushedReceived.load(); })) {
+        if (!flushedCv.wait_for(lock, std::chrono::seconds(30), [this] { return isFlushedReceived.load() || IsSynthesisCancelled(); })) {
             SPDLOG_ERROR("[{}] TTS Flushed message timeout!", stream_sid);
             return;
         }
     }
 
+    if (IsSynthesisCancelled()) {
+        SPDLOG_INFO("[{}] Synthesis cancelled", stream_sid);
+        return;
+    }
+
     std::vector<uint8_t> finalAudio;
     {
         std::lock_guard<std::mutex> lock(accumulatedAudioMutex);
@@ -128,10 +177,30 @@ void DeepgramTTS::ImplSynthesiseVoice(const std::string& text, const std::string
     auto endTime = std::chrono::high_resolution_clock::now();
     auto ttsLatency = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_startTime).count();
 
-    SPDLOG_INFO("[{}] Final audio collected with size: {}", stream_sid, finalAudio.size());
+    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Final audio collected with size: {}", stream_sid, finalAudio.size());
     SynthesisedAudioData(finalAudio, hashKey, ttsLatency);
 }
 
+void DeepgramTTS::ImplCancelSynthesis() {
+    // Drop whatever the server still has buffered for this segment, and ignore what it already sent
+    bool connected = isConnected.load();
+    {
+        std::lock_guard<std::mutex> lock(flushedMutex);
+        if (connected) m_clearing = true;
+    }
+    if (connected) {
+        std::lock_guard<std::mutex> sendLock(sendMutex);
+        nlohmann::json clearMsg = {{"type", "Clear"}};
+        webSocket.send(clearMsg.dump());
+    }
+    flushedCv.notify_all();
+}
+
+void DeepgramTTS::Reconnect() {
+    webSocket.stop();
+    isConnected = false;
+    StartWebSocket();
+}
 
 void DeepgramTTS::CloseConnection() {
     if (isConnected) {
@@ -0,0 +1,132 @@
+#include "DuplexSession.h"
+#include "TTSModuleBase.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+DuplexSession::DuplexSession(std::shared_ptr<I_STTModule> stt, std::shared_ptr<I_TTSModule> tts)
+    : DuplexSession(std::move(stt), std::move(tts), Options()) {}
+
+DuplexSession::DuplexSession(std::shared_ptr<I_STTModule> stt, std::shared_ptr<I_TTSModule> tts,
+                             const Options& options)
+    : m_stt(std::move(stt)), m_tts(std::move(tts)), m_options(options), m_vad(options.vad),
+      m_speaking(std::make_shared<std::atomic<int>>(0)), m_eventTarget(std::make_shared<EventTarget>()) {
+    if (!m_stt || !m_tts) throw std::invalid_argument("DuplexSession needs both an STT and a TTS module");
+    if (auto base = std::dynamic_pointer_cast<TTSModuleBase>(m_tts)) m_labels = base->MetricsLabels();
+    m_eventTarget->session = this;
+    m_stt->SetEventCallback([target = m_eventTarget](const STTEvent& event) {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        if (target->session) target->session->OnSTTEvent(event);
+    });
+}
+
+DuplexSession::~DuplexSession() {
+    m_stt->SetEventCallback(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(m_eventTarget->mutex);
+        m_eventTarget->session = nullptr;
+    }
+    // No event can start a barge-in from here on
+    std::future<void> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(m_bargeInTask);
+    }
+    if (pending.valid()) pending.wait();
+}
+
+void DuplexSession::StreamAudioData(std::vector<uint8_t> audioData) {
+    if (m_options.bargeIn && m_vad.process(audioData.data(), audioData.size())) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++m_stats.vadOnsets;
+        }
+        if (IsSpeaking()) BargeIn(BargeInSource::LocalVAD);
+    }
+    m_stt->StreamAudioData(std::move(audioData));
+}
+
+void DuplexSession::StartRecognition() {
+    m_vad.reset();
+    m_stt->StartRecognition();
+}
+
+void DuplexSession::StopRecognition() {
+    m_stt->StopRecognition();
+}
+
+SpeakHandle DuplexSession::Speak(const std::string& text) {
+    auto speaking = m_speaking;
+    speaking->fetch_add(1);
+    SpeakHandle handle = m_tts->Speak(text);
+    handle.done.then([speaking](const SpeakOutcome&) { speaking->fetch_sub(1); });
+    return handle;
+}
+
+void DuplexSession::StopSpeak() {
+    m_tts->StopSpeak();
+}
+
+void DuplexSession::OnSTTEvent(const STTEvent& event) {
+    if (event.type == STTEventType::SpeechStarted) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++m_stats.vendorOnsets;
+        }
+        if (m_options.bargeIn && m_options.vendorSpeechStart && IsSpeaking()) {
+            BargeIn(BargeInSource::VendorSpeechStart);
+        }
+    }
+
+    std::function<void(const STTEvent&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        callback = m_eventCallback;
+    }
+    if (callback) callback(event);
+}
+
+void DuplexSession::BargeIn(BargeInSource source) {
+    auto detected = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    // Local and vendor detection of the same onset; the first one is already stopping playout
+    if (m_bargeInTask.valid() &&
+        m_bargeInTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    m_bargeInTask = std::async(std::launch::async, [this, source, detected] {
+        m_tts->StopSpeak();
+        double reactionMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - detected).count();
+        Metrics::getInstance().recordLatency(Metric::BargeInReaction, m_labels, reactionMs);
+        SPDLOG_INFO("[{}] Barge-in ({}): playout stopped after {:.1f} ms", m_labels.session,
+                    source == BargeInSource::LocalVAD ? "vad" : "vendor", reactionMs);
+
+        std::function<void(BargeInSource, double)> callback;
+        {
+            std::lock_guard<std::mutex> statsLock(mutex);
+            ++m_stats.bargeIns;
+            m_stats.lastReactionMs = reactionMs;
+            m_stats.maxReactionMs = std::max(m_stats.maxReactionMs, reactionMs);
+            callback = m_bargeInCallback;
+        }
+        if (callback) callback(source, reactionMs);
+    });
+}
+
+void DuplexSession::SetBargeInCallback(std::function<void(BargeInSource source, double reactionMs)> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    m_bargeInCallback = std::move(callback);
+}
+
+void DuplexSession::SetEventCallback(std::function<void(const STTEvent&)> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    m_eventCallback = std::move(callback);
+}
+
+DuplexSession::Stats DuplexSession::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return m_stats;
+}
@@ -1,4 +1,5 @@
 #include "ElevenlabsTTS.h"
+#include "VendorEndpoints.h"
 
 bool ElevenlabsTTS::Initialise(const std::string& apiKey, const std::string& region) {
     m_apiKey = apiKey;
@@ -9,6 +10,18 @@ bool ElevenlabsTTS::Initialise(const std::string& apiKey, const std::string& reg
     }
     m_voiceId = voiceInfo->first;
     m_modelId = voiceInfo->second;
+    // Stream at the playout rate when offered (pcm_8000 covers telephony), otherwise at 16 kHz and resample locally
+    switch (m_outputSampleRate) {
+    case 8000:
+    case 16000:
+    case 22050:
+    case 24000:
+    case 44100:
+        m_vendorSampleRate = m_outputSampleRate;
+        break;
+    default:
+        m_vendorSampleRate = 16000;
+    }
     startWebSocket();
     return true;
 }
@@ -16,7 +29,7 @@ bool ElevenlabsTTS::Initialise(const std::string& apiKey, const std::string& reg
 // Fetch voice_id and best model_id for given voice name
 std::optional<std::pair<std::string, std::string>> ElevenlabsTTS::getVoiceIdAndModel(const std::string& voiceName) {
     cpr::Response response = cpr::Get(
-        cpr::Url{"https://api.elevenlabs.io/v2/voices"},
+        cpr::Url{VendorEndpoints::ElevenlabsApi() + "/v2/voices"},
         cpr::Header{{"xi-api-key", m_apiKey}},
         cpr::Parameters{{"include_total_count", "true"}, {"search", voiceName}}
     );
@@ -46,7 +59,7 @@ std::optional<std::pair<std::string, std::string>> ElevenlabsTTS::getVoiceIdAndM
 
 std::string ElevenlabsTTS::buildWebSocketURL() const {
     // wss://api.elevenlabs.io/v1/text-to-speech/cgSgspJ2msm6clMCkdW9/stream-input?output_format=pcm_16000
-    return "wss://api.elevenlabs.io/v1/text-to-speech/" + m_voiceId + "/stream-input?output_format=pcm_16000";
+    return VendorEndpoints::ElevenlabsStream() + "/v1/text-to-speech/" + m_voiceId + "/stream-input?output_format=pcm_" + std::to_string(m_vendorSampleRate);
 }
 
 void ElevenlabsTTS::startWebSocket() {
@@ -63,12 +76,17 @@ void ElevenlabsTTS::startWebSocket() {
             handleMessage(msg->str);
         } else if (msg->type == ix::WebSocketMessageType::Open) {
             SPDLOG_INFO("ElevenLabs WebSocket connection opened.");
-            m_isConnected = true;
+            {
+                std::lock_guard<std::mutex> lock(wsMutex);
+                ++m_openedConnection;
+                m_isConnected = true;
+            }
             wsCv.notify_all();
         } else if (msg->type == ix::WebSocketMessageType::Error) {
             SPDLOG_ERROR("WebSocket Error: {}", msg->errorInfo.reason);
         } else if (msg->type == ix::WebSocketMessageType::Close) {
             SPDLOG_INFO("ElevenLabs WebSocket connection closed.");
+            std::lock_guard<std::mutex> lock(wsMutex);
             m_isConnected = false;
         }
     });
@@ -90,24 +108,44 @@ void ElevenlabsTTS::sendInitialSettings() {
     webSocket.send(initPayload.dump());
 }
 
+bool ElevenlabsTTS::claimFreshConnection() {
+    auto fresh = [this] { return m_isConnected && m_openedConnection != m_requestConnection; };
+    std::unique_lock<std::mutex> wsLock(wsMutex);
+    // The previous request's connection is closing; it normally reconnects on its own
+    if (!wsCv.wait_for(wsLock, std::chrono::seconds(5), fresh)) {
+        wsLock.unlock();
+        SPDLOG_WARN("[{}] ElevenLabs did not reconnect; reconnecting now", stream_sid);
+        webSocket.stop();
+        webSocket.start();
+        wsLock.lock();
+        if (!wsCv.wait_for(wsLock, std::chrono::seconds(5), fresh)) return false;
+    }
+    m_requestConnection = m_openedConnection;
+    return true;
+}
+
 void ElevenlabsTTS::ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) {
-    SPDLOG_INFO("[{}] Audio buffer text: {}", stream_sid, text);
+    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Starting synthesis ({} chars)", stream_sid, text.size());
+    SPDLOG_DEBUG("[{}] Audio buffer text: {}", stream_sid, text);
 
     std::unique_lock<std::mutex> lock(ttsProcessingMutex);
+    m_startTime = std::chrono::high_resolution_clock::now();
+
+    if (!claimFreshConnection()) {
+        SPDLOG_ERROR("[{}] TTS WebSocket connection timeout!", stream_sid);
+        return;
+    }
+    // Nothing from an earlier connection is accepted past this point
     {
         std::lock_guard<std::mutex> audioLock(accumulatedAudioMutex);
         m_accumulatedAudioBuffer.clear();
     }
-
     m_isFinalReceived = false;
     m_currentHashKey = hashKey;
-    m_startTime = std::chrono::high_resolution_clock::now();
 
-    {
-        std::unique_lock<std::mutex> wsLock(wsMutex);
-        if (!m_isConnected) {
-            wsCv.wait_for(wsLock, std::chrono::seconds(5), [this] { return m_isConnected.load(); });
-        }
+    if (IsSynthesisCancelled()) {
+        webSocket.close();
+        return;
     }
 
     sendInitialSettings();
@@ -135,13 +173,23 @@ void ElevenlabsTTS::ImplSynthesiseVoice(const std::string& text, const std::stri
 
     {
         std::unique_lock<std::mutex> finalLock(m_finalMutex);
-        m_finalCv.wait(finalLock, [this] { return m_isFinalReceived.load(); });
+        if (!m_finalCv.wait_for(finalLock, std::chrono::seconds(30), [this] { return m_isFinalReceived.load() || IsSynthesisCancelled(); })) {
+            SPDLOG_ERROR("[{}] TTS isFinal message timeout!", stream_sid);
+            // Stop the stalled stream; the next request claims a fresh connection anyway
+            webSocket.close();
+            return;
+        }
+    }
+
+    if (IsSynthesisCancelled()) {
+        SPDLOG_INFO("[{}] Synthesis cancelled", stream_sid);
+        return;
     }
 
     {
         std::lock_guard<std::mutex> audioLock(accumulatedAudioMutex);
         if (!m_accumulatedAudioBuffer.empty()) {
-            SPDLOG_INFO("[{}] Audio buffer size: {}", hashKey, m_accumulatedAudioBuffer.size());
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Audio buffer size: {}", stream_sid, m_accumulatedAudioBuffer.size());
             auto endTime = std::chrono::high_resolution_clock::now();
             auto ttsLatency = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_startTime).count();
             SynthesisedAudioData(m_accumulatedAudioBuffer, m_currentHashKey, ttsLatency);
@@ -151,27 +199,42 @@ void ElevenlabsTTS::ImplSynthesiseVoice(const std::string& text, const std::stri
 
 void ElevenlabsTTS::handleMessage(const std::string& message) {
     try {
+        {
+            std::lock_guard<std::mutex> lock(wsMutex);
+            if (m_openedConnection != m_requestConnection) return;  // a cancelled or finished request's
+        }
         auto jsonMsg = nlohmann::json::parse(message);
-        SPDLOG_DEBUG("[{}] Text Response: {}", stream_sid, message);
+        SPDLOG_DEBUG("[{}] Text Response: {}", SessionId(), message);
 
         if (jsonMsg.contains("audio") && !jsonMsg["audio"].is_null()) {
-            std::string base64Audio = jsonMsg["audio"];
-            std::string decodedAudioStr = siprtc::base64_decode(base64Audio);
-            std::vector<uint8_t> decodedAudio(decodedAudioStr.begin(), decodedAudioStr.end());
-            
+            const std::string& base64Audio = jsonMsg["audio"].get_ref<const std::string&>();
+
+            // Decode straight into the accumulated buffer, no intermediate copies
             std::lock_guard<std::mutex> audioLock(accumulatedAudioMutex);
-            m_accumulatedAudioBuffer.insert(m_accumulatedAudioBuffer.end(), decodedAudio.begin(), decodedAudio.end());
+            if (!Base64Decoder::decodeAppend(base64Audio, m_accumulatedAudioBuffer)) {
+                SPDLOG_ERROR("[{}] Invalid base64 audio chunk of size {}", SessionId(), base64Audio.size());
+            }
+            AudioChunkReceived();
         }
 
         if (jsonMsg.contains("isFinal") && !jsonMsg["isFinal"].is_null() && jsonMsg["isFinal"].get<bool>()) {
-            SPDLOG_INFO("[{}] Received isFinal=true", stream_sid);
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Received isFinal=true", SessionId());
             m_isFinalReceived = true;
             m_finalCv.notify_all();
             webSocket.close();
         }
     } catch (const std::exception& e) {
-        SPDLOG_ERROR("[{}] Failed to handle message: {}", stream_sid, e.what());
+        SPDLOG_ERROR("[{}] Failed to handle message: {}", SessionId(), e.what());
+    }
+}
+
+void ElevenlabsTTS::ImplCancelSynthesis() {
+    // Closing the stream stops generation; the next segment waits for a new connection
+    webSocket.close();
+    {
+        std::lock_guard<std::mutex> finalLock(m_finalMutex);
     }
+    m_finalCv.notify_all();
 }
 
 void ElevenlabsTTS::CloseConnection() {
@@ -0,0 +1,76 @@
+#include "EnergyVAD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr double kSilenceDb = -100.0;
+constexpr double kInitialFloorDb = -60.0;
+// Floor tracking: fall to a quieter level at once, rise slowly so speech cannot pull it up
+constexpr double kFloorRise = 0.02;
+
+} // namespace
+
+EnergyVAD::EnergyVAD() : EnergyVAD(Options()) {}
+
+EnergyVAD::EnergyVAD(const Options& options) : m_options(options), m_noiseFloorDb(kInitialFloorDb) {}
+
+void EnergyVAD::reset() {
+    m_noiseFloorDb = kInitialFloorDb;
+    m_voicedMs = 0;
+    m_unvoicedMs = 0;
+    m_inSpeech = false;
+}
+
+double EnergyVAD::levelDb(const int16_t* samples, size_t count) {
+    if (count == 0) return kSilenceDb;
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i) sum += static_cast<double>(samples[i]) * samples[i];
+    double rms = std::sqrt(sum / count) / 32768.0;
+    return rms > 0 ? std::max(kSilenceDb, 20.0 * std::log10(rms)) : kSilenceDb;
+}
+
+bool EnergyVAD::process(const uint8_t* pcm, size_t size) {
+    size_t count = size / 2;
+    if (count == 0 || m_options.sampleRate <= 0) return false;
+
+    double level;
+    if (reinterpret_cast<uintptr_t>(pcm) % alignof(int16_t) == 0) {
+        level = levelDb(reinterpret_cast<const int16_t*>(pcm), count);
+    } else {
+        std::vector<int16_t> samples(count);
+        std::memcpy(samples.data(), pcm, count * 2);
+        level = levelDb(samples.data(), count);
+    }
+    double frameMs = 1000.0 * count / m_options.sampleRate;
+    bool voiced = level >= m_options.thresholdDb && level >= m_noiseFloorDb + m_options.marginDb;
+
+    if (voiced) {
+        m_unvoicedMs = 0;
+        m_voicedMs += frameMs;
+        if (!m_inSpeech && m_voicedMs >= m_options.onsetMs) {
+            m_inSpeech = true;
+            return true;
+        }
+        return false;
+    }
+
+    m_voicedMs = std::max(0.0, m_voicedMs - frameMs);
+    if (level < m_noiseFloorDb) {
+        m_noiseFloorDb = level;
+    } else if (!m_inSpeech) {
+        m_noiseFloorDb += (level - m_noiseFloorDb) * kFloorRise;
+    }
+    if (m_inSpeech) {
+        m_unvoicedMs += frameMs;
+        if (m_unvoicedMs >= m_options.releaseMs) {
+            m_inSpeech = false;
+            m_unvoicedMs = 0;
+            m_voicedMs = 0;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,144 @@
+#include "HedgedTTS.h"
+
+namespace {
+
+// Shared between the hedging thread and the two vendor threads of one segment
+struct HedgeRace {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int winner = -1;
+    bool started[2] = {false, false};
+    bool done[2] = {false, false};
+    std::vector<uint8_t> audio[2];
+    std::shared_ptr<std::atomic<bool>> cancelled[2];
+    std::chrono::steady_clock::time_point firstAudioAt;
+};
+
+} // namespace
+
+HedgedTTS::HedgedTTS(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb,
+                     std::shared_ptr<TTSModuleBase> primary, std::shared_ptr<TTSModuleBase> secondary,
+                     std::chrono::milliseconds firstAudioDeadline, std::chrono::milliseconds segmentDeadline)
+    : TTSModuleBase(sid, cb, primary->VoiceName()),
+      m_primary(std::move(primary)),
+      m_secondary(std::move(secondary)),
+      m_firstAudioDeadline(firstAudioDeadline),
+      m_segmentDeadline(segmentDeadline) {
+    m_reportsVendorMetrics = false;
+    m_outputSampleRate = m_primary->OutputSampleRate();
+    m_vendorSampleRate = m_outputSampleRate;
+    m_secondary->SetOutputSampleRate(m_outputSampleRate);
+}
+
+bool HedgedTTS::Initialise(const std::string& apiKey, const std::string& region) {
+    return true;
+}
+
+void HedgedTTS::SetOutputSampleRate(int sampleRate) {
+    // Vendors resample before handing audio over, so nothing is converted at this level
+    TTSModuleBase::SetOutputSampleRate(sampleRate);
+    m_vendorSampleRate = sampleRate;
+    m_primary->SetOutputSampleRate(sampleRate);
+    m_secondary->SetOutputSampleRate(sampleRate);
+}
+
+void HedgedTTS::ImplCancelSynthesis() {
+    m_primary->CancelSynthesis();
+    m_secondary->CancelSynthesis();
+}
+
+void HedgedTTS::ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) {
+    auto race = std::make_shared<HedgeRace>();
+    TTSModuleBase* modules[2] = {m_primary.get(), m_secondary.get()};
+    std::string keys[2] = {hashKey, m_secondary->CacheKey(text)};
+    std::thread workers[2];
+    auto startTime = std::chrono::steady_clock::now();
+    auto deadline = startTime + m_segmentDeadline;
+
+    // Called with race->mutex held
+    auto launch = [&](int index) {
+        race->started[index] = true;
+        race->cancelled[index] = std::make_shared<std::atomic<bool>>(false);
+        workers[index] = std::thread([race, index, module = modules[index], text, key = keys[index]] {
+            module->SynthesiseSegment(text, key, race->cancelled[index],
+                [race, index] {
+                    std::lock_guard<std::mutex> lock(race->mutex);
+                    if (race->winner < 0) {
+                        race->winner = index;
+                        race->firstAudioAt = std::chrono::steady_clock::now();
+                    }
+                    race->cv.notify_all();
+                },
+                [race, index](std::vector<uint8_t> audio, int latencyMs) {
+                    std::lock_guard<std::mutex> lock(race->mutex);
+                    race->audio[index] = std::move(audio);
+                });
+            std::lock_guard<std::mutex> lock(race->mutex);
+            race->done[index] = true;
+            race->cv.notify_all();
+        });
+    };
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    launch(0);
+
+    race->cv.wait_for(lock, m_firstAudioDeadline, [&] { return race->winner >= 0 || race->done[0]; });
+    if (race->winner < 0 && !IsSynthesisCancelled()) {
+        SPDLOG_WARN("[{}] No audio from {} within {} ms, hedging with {}", stream_sid,
+                    m_primary->VoiceName(), m_firstAudioDeadline.count(), m_secondary->VoiceName());
+        launch(1);
+    }
+
+    // A leg that never finishes (a socket dropped mid-segment) must not hold the speech thread
+    auto abandon = [&] {
+        for (int index = 0; index < 2; ++index) {
+            if (race->started[index] && !race->done[index]) race->cancelled[index]->store(true);
+        }
+        lock.unlock();
+        for (int index = 0; index < 2; ++index) {
+            if (race->started[index]) modules[index]->CancelSynthesis();
+        }
+        // Cancelled vendors stop waiting on their service
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+        throw std::runtime_error("Hedged TTS segment exceeded " + std::to_string(m_segmentDeadline.count()) + " ms");
+    };
+
+    if (!race->cv.wait_until(lock, deadline, [&] {
+            return race->winner >= 0 || ((!race->started[0] || race->done[0]) && (!race->started[1] || race->done[1]));
+        })) {
+        abandon();
+    }
+
+    int winner = race->winner;
+    if (winner >= 0) {
+        int loser = 1 - winner;
+        if (race->started[loser] && !race->done[loser]) {
+            race->cancelled[loser]->store(true);
+            lock.unlock();
+            modules[loser]->CancelSynthesis();
+            lock.lock();
+        }
+        if (!race->cv.wait_until(lock, deadline, [&] { return race->done[winner]; })) abandon();
+
+        auto firstAudioMs = std::chrono::duration_cast<std::chrono::milliseconds>(race->firstAudioAt - startTime).count();
+        SPDLOG_INFO("[{}] Hedged TTS served by {} (first audio {} ms)", stream_sid, modules[winner]->VoiceName(), firstAudioMs);
+    }
+
+    std::vector<uint8_t> audio = winner >= 0 ? std::move(race->audio[winner]) : std::vector<uint8_t>();
+    lock.unlock();
+
+    if (audio.empty()) {
+        SPDLOG_ERROR("[{}] Hedged TTS produced no audio for '{}'", stream_sid, text);
+    } else {
+        // Secondary audio is cached under its own key so primary lookups never return the other voice
+        auto ttsLatency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        SynthesisedAudioData(std::move(audio), keys[winner], ttsLatency);
+    }
+
+    // The cancelled vendor has normally unwound by now
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
@@ -0,0 +1,82 @@
+#include "Logging.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+std::atomic<uint64_t> Logging::suppressed{0};
+
+namespace {
+
+std::atomic<double> limitPerSecond{20.0};
+std::atomic<uint32_t> limitBurst{50};
+std::atomic<uint32_t> limitSampleEvery{100};
+
+} // namespace
+
+void Logging::enableAsync() {
+    enableAsync(AsyncOptions());
+}
+
+void Logging::enableAsync(const AsyncOptions& options) {
+    spdlog::init_thread_pool(options.queueSize, 1);
+
+    std::vector<spdlog::sink_ptr> sinks = options.sinks;
+    if (sinks.empty()) sinks.push_back(std::make_shared<spdlog::sinks::stderr_color_sink_mt>());
+
+    auto previous = spdlog::default_logger();
+    auto logger = std::make_shared<spdlog::async_logger>(
+        "voicekit", sinks.begin(), sinks.end(), spdlog::thread_pool(),
+        options.blockWhenFull ? spdlog::async_overflow_policy::block : spdlog::async_overflow_policy::overrun_oldest);
+    if (previous) {
+        logger->set_level(previous->level());
+        logger->flush_on(previous->flush_level());
+    }
+    spdlog::set_default_logger(logger);
+    spdlog::flush_every(options.flushInterval);
+}
+
+void Logging::setSessionLimits(const SessionLimits& limits) {
+    limitPerSecond = limits.perSecond;
+    limitBurst = limits.burst;
+    limitSampleEvery = limits.sampleEvery;
+}
+
+Logging::SessionLimits Logging::getSessionLimits() {
+    return {limitPerSecond.load(), limitBurst.load(), limitSampleEvery.load()};
+}
+
+uint64_t Logging::suppressedMessages() {
+    return suppressed.load(std::memory_order_relaxed);
+}
+
+uint64_t Logging::droppedMessages() {
+    auto pool = spdlog::thread_pool();
+    return pool ? pool->overrun_counter() : 0;
+}
+
+bool LogLimiter::allow() {
+    double perSecond = limitPerSecond.load(std::memory_order_relaxed);
+    double burst = limitBurst.load(std::memory_order_relaxed);
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (m_tokens < 0.0) {
+        m_tokens = burst;
+    } else {
+        std::chrono::duration<double> elapsed = now - m_refilledAt;
+        m_tokens = std::min(burst, m_tokens + elapsed.count() * perSecond);
+    }
+    m_refilledAt = now;
+
+    if (m_tokens >= 1.0) {
+        m_tokens -= 1.0;
+        m_overLimit = 0;
+        return true;
+    }
+    uint32_t sampleEvery = limitSampleEvery.load(std::memory_order_relaxed);
+    if (sampleEvery && ++m_overLimit % sampleEvery == 0) return true;
+
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    Logging::suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
@@ -0,0 +1,95 @@
+#include "Metrics.h"
+
+const char* MetricName(Metric metric) {
+    switch (metric) {
+    case Metric::TTSQueueWait: return "voicekit_tts_queue_wait";
+    case Metric::TTSTimeToFirstAudio: return "voicekit_tts_time_to_first_audio";
+    case Metric::TTSSynthesisTime: return "voicekit_tts_synthesis_time";
+    case Metric::TTSCachedPlayoutStart: return "voicekit_tts_cached_playout_start";
+    case Metric::TTSPlayoutUnderrun: return "voicekit_tts_playout_underruns";
+    case Metric::STTQueueWait: return "voicekit_stt_queue_wait";
+    case Metric::STTFinalResult: return "voicekit_stt_final_results";
+    case Metric::BargeInReaction: return "voicekit_barge_in_reaction";
+    }
+    return "voicekit_unknown";
+}
+
+bool IsCounterMetric(Metric metric) {
+    return metric == Metric::TTSPlayoutUnderrun || metric == Metric::STTFinalResult;
+}
+
+Metrics& Metrics::getInstance() {
+    static Metrics instance;
+    return instance;
+}
+
+namespace {
+
+class LabelledSeries : public I_MetricsSink::Series {
+public:
+    LabelledSeries(I_MetricsSink& sink, const MetricLabels& labels) : m_sink(sink), m_labels(labels) {}
+
+    void RecordLatency(Metric metric, double milliseconds) override { m_sink.RecordLatency(metric, m_labels, milliseconds); }
+    void IncrementCounter(Metric metric, uint64_t delta) override { m_sink.IncrementCounter(metric, m_labels, delta); }
+
+private:
+    I_MetricsSink& m_sink;  // MetricsSeries keeps the sink alive alongside its series
+    MetricLabels m_labels;
+};
+
+} // namespace
+
+std::shared_ptr<I_MetricsSink::Series> I_MetricsSink::Resolve(const MetricLabels& labels) {
+    return std::make_shared<LabelledSeries>(*this, labels);
+}
+
+void Metrics::setSink(std::shared_ptr<I_MetricsSink> sink) {
+    std::lock_guard<std::mutex> lock(mutex);
+    m_enabled = sink != nullptr;
+    std::atomic_store(&m_sink, std::move(sink));
+}
+
+void Metrics::recordLatency(Metric metric, const MetricLabels& labels, double milliseconds) {
+    if (!enabled()) return;
+    if (auto sink = getSink()) sink->RecordLatency(metric, labels, milliseconds);
+}
+
+void Metrics::recordLatency(Metric metric, const MetricLabels& labels, std::chrono::steady_clock::time_point since) {
+    if (!enabled()) return;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - since;
+    recordLatency(metric, labels, elapsed.count());
+}
+
+void Metrics::incrementCounter(Metric metric, const MetricLabels& labels, uint64_t delta) {
+    if (!enabled()) return;
+    if (auto sink = getSink()) sink->IncrementCounter(metric, labels, delta);
+}
+
+std::shared_ptr<const MetricsSeries::Binding> MetricsSeries::resolve() {
+    auto sink = Metrics::getInstance().getSink();
+    if (!sink) return nullptr;
+    uint64_t generation = m_generation.load();
+    auto binding = std::atomic_load(&m_binding);
+    if (binding && binding->sink == sink && binding->generation == generation) return binding;
+
+    // Labels are read after the generation, so a concurrent invalidate() forces another resolve
+    auto fresh = std::make_shared<const Binding>(Binding{sink, sink->Resolve(m_labels()), generation});
+    std::atomic_store(&m_binding, fresh);
+    return fresh;
+}
+
+void MetricsSeries::recordLatency(Metric metric, double milliseconds) {
+    if (!Metrics::getInstance().enabled()) return;
+    if (auto binding = resolve()) binding->series->RecordLatency(metric, milliseconds);
+}
+
+void MetricsSeries::recordLatency(Metric metric, std::chrono::steady_clock::time_point since) {
+    if (!Metrics::getInstance().enabled()) return;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - since;
+    recordLatency(metric, elapsed.count());
+}
+
+void MetricsSeries::incrementCounter(Metric metric, uint64_t delta) {
+    if (!Metrics::getInstance().enabled()) return;
+    if (auto binding = resolve()) binding->series->IncrementCounter(metric, delta);
+}
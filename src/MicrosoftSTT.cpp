@@ -1,21 +1,36 @@
 #include "MicrosoftSTT.h"
 
+MicrosoftSTT::MicrosoftSTT(const std::string& sid, std::function<void(std::string&)> cb, std::string lang)
+    : STTModuleBase(sid, std::move(cb), std::move(lang)) {
+    m_asyncStartStop = true;
+}
+
+MicrosoftSTT::~MicrosoftSTT() {
+    // No further start or stop can be queued once the processing thread is gone
+    StopProcessing();
+    std::shared_future<void> pending;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        pending = lastControl;
+    }
+    if (pending.valid()) pending.wait();
+}
 
 void MicrosoftSTT::InitialiseSTTModule(const std::string& subscriptionKey, const std::string& region) {
     std::shared_ptr<MicrosoftSTT> self = shared_from_this();  // ✅ Now safe to use
 
-    speechConfig = SpeechConfig::FromSubscription(subscriptionKey, region);
-    auto audioFormat = AudioStreamFormat::GetWaveFormatPCM(8000, 16, 1);
+    // Shared per key, region and language; carries the silence timeouts
+    speechConfig = AzureSpeech::getInstance().recognitionConfig(subscriptionKey, region, language);
+    // Push streams take 8 or 16 kHz PCM; wideband input is resampled down to 16 kHz
+    m_vendorSampleRate = m_inputSampleRate >= 16000 ? 16000 : 8000;
+    auto audioFormat = AudioStreamFormat::GetWaveFormatPCM(m_vendorSampleRate, 16, 1);
     pushStream = AudioInputStream::CreatePushStream(audioFormat);
     audioConfig = AudioConfig::FromStreamInput(pushStream);
 
-    speechConfig->SetProperty(PropertyId::SpeechServiceConnection_InitialSilenceTimeoutMs, "10000");
-    speechConfig->SetProperty(PropertyId::SpeechServiceConnection_EndSilenceTimeoutMs, "1000");
-    speechConfig->SetProperty(PropertyId::Speech_SegmentationSilenceTimeoutMs, "3000");
-
     recognizer = SpeechRecognizer::FromConfig(speechConfig, audioConfig);
-    speechConfig->SetSpeechRecognitionLanguage(language);
     ImplRecognize();
+    // Connect now rather than on StartRecognition, so the first utterance skips the setup
+    AzureSpeech::openConnection(recognizer);
 }
 
 void MicrosoftSTT::ImplStreamAudioData(std::vector<uint8_t> audioData)  {
@@ -24,16 +39,118 @@ void MicrosoftSTT::ImplStreamAudioData(std::vector<uint8_t> audioData)  {
     }
 }
 
+// The recognizer is created once in InitialiseSTTModule and reused by every start/stop of the call.
+// Azure takes hundreds of ms to negotiate a start; frames keep flowing into the push stream meanwhile.
 void MicrosoftSTT::ImplStartRecognition() {
-    if (recognizer){
-        recognizer->StartContinuousRecognitionAsync().get();
-    }
+    QueueRecognitionChange(true);
 }
 
 void MicrosoftSTT::ImplStopRecognition() {
-    if (recognizer){
-        recognizer->StopContinuousRecognitionAsync().get();
+    QueueRecognitionChange(false);
+}
+
+bool MicrosoftSTT::ImplControlSettled() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    return !lastControl.valid() || lastControl.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void MicrosoftSTT::QueueRecognitionChange(bool start) {
+    if (!recognizer) {
+        RecognitionEvent(STTEventType::Error, "Recognizer not initialised");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(controlMutex);
+    std::shared_future<void> previous = lastControl;
+    lastControl = std::async(std::launch::async, [this, previous, start] {
+        // The SDK does not order overlapping start and stop calls, so each waits for the last
+        if (previous.valid()) previous.wait();
+        auto requested = std::chrono::steady_clock::now();
+        try {
+            if (start) {
+                recognizer->StartContinuousRecognitionAsync().get();
+            } else {
+                recognizer->StopContinuousRecognitionAsync().get();
+            }
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("[{}] {} recognition failed: {}", SessionId(), start ? "Start" : "Stop", e.what());
+            RecognitionEvent(STTEventType::Error, e.what());
+            return;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - requested);
+        SPDLOG_INFO("[{}] Recognition {} after {} ms", SessionId(), start ? "started" : "stopped", elapsed.count());
+        RecognitionEvent(start ? STTEventType::RecognitionStarted : STTEventType::RecognitionStopped);
+    }).share();
+}
+
+void MicrosoftSTT::ImplBeginBulk() {
+    if (!speechConfig) throw std::runtime_error("Microsoft STT bulk transcription before InitialiseSTTModule");
+    {
+        std::lock_guard<std::mutex> lock(bulkDoneMutex);
+        bulkDone = false;
+        bulkError.clear();
+    }
+    auto audioFormat = AudioStreamFormat::GetWaveFormatPCM(m_vendorSampleRate, 16, 1);
+    bulkStream = AudioInputStream::CreatePushStream(audioFormat);
+    bulkRecognizer = SpeechRecognizer::FromConfig(speechConfig, AudioConfig::FromStreamInput(bulkStream));
+
+    bulkRecognizer->Recognized += [this](const SpeechRecognitionEventArgs& e) {
+        if (e.Result->Reason != ResultReason::RecognizedSpeech) return;
+        // Offsets are in 100 ns ticks from the start of the stream
+        double startMs = e.Result->Offset() / 10000.0;
+        double endMs = startMs + e.Result->Duration() / 10000.0;
+        std::string text = e.Result->Text;
+        RecognisedSegment(text, startMs, endMs);
+    };
+    auto finish = [this](const std::string& error) {
+        std::lock_guard<std::mutex> lock(bulkDoneMutex);
+        if (bulkError.empty()) bulkError = error;
+        bulkDone = true;
+        bulkDoneCV.notify_all();
+    };
+    bulkRecognizer->Canceled += [this, finish](const SpeechRecognitionCanceledEventArgs& e) {
+        if (e.Reason == CancellationReason::Error) {
+            SPDLOG_ERROR("[{}] Bulk recognition CANCELED: ErrorDetails= {}", SessionId(), e.ErrorDetails);
+            finish(e.ErrorDetails);
+        } else {
+            finish("");  // EndOfStream: every result for the closed stream has been delivered
+        }
+    };
+    bulkRecognizer->SessionStopped += [finish](const SessionEventArgs&) { finish(""); };
+
+    auto started = bulkRecognizer->StartContinuousRecognitionAsync();
+    if (started.wait_for(m_bulkOptions.readyTimeout) != std::future_status::ready) {
+        throw std::runtime_error("Timed out starting Microsoft bulk recognition");
+    }
+    started.get();
+}
+
+void MicrosoftSTT::ImplStreamBulk(const uint8_t* audioData, size_t size) {
+    // The push stream buffers without limit; the SDK reads it as fast as the service accepts
+    bulkStream->Write(const_cast<uint8_t*>(audioData), static_cast<uint32_t>(size));
+}
+
+void MicrosoftSTT::ImplEndBulk() {
+    bulkStream->Close();
+    std::string error;
+    bool finished;
+    {
+        std::unique_lock<std::mutex> lock(bulkDoneMutex);
+        finished = bulkDoneCV.wait_for(lock, m_bulkOptions.finishTimeout, [this] { return bulkDone; });
+        error = bulkError;
     }
+    bulkRecognizer->StopContinuousRecognitionAsync().get();
+    bulkRecognizer.reset();
+    bulkStream.reset();
+    if (!finished) throw std::runtime_error("Timed out waiting for Microsoft to finish the bulk transcript");
+    if (!error.empty()) throw std::runtime_error("Microsoft bulk recognition failed: " + error);
+}
+
+void MicrosoftSTT::ImplAbortBulk() {
+    // Released on return even if the stop throws
+    auto recognizer = std::move(bulkRecognizer);
+    auto stream = std::move(bulkStream);
+    if (stream) stream->Close();
+    if (recognizer) recognizer->StopContinuousRecognitionAsync().get();
 }
 
 void MicrosoftSTT::ImplRecognize() {
@@ -43,7 +160,7 @@ void MicrosoftSTT::ImplRecognize() {
         // Intermediate result (hypothesis).
         if (e.Result->Reason == ResultReason::RecognizingSpeech)
         {
-            SPDLOG_INFO("Recognizing: {}", e.Result->Text);
+            VOICEKIT_LOG_FRAME("[{}] Recognizing: {}", SessionId(), e.Result->Text);
         }
         else if (e.Result->Reason == ResultReason::RecognizingKeyword)
         {
@@ -56,12 +173,13 @@ void MicrosoftSTT::ImplRecognize() {
         if (e.Result->Reason == ResultReason::RecognizedKeyword)
         {
             // Keyword detected, speech recognition will start.
-            SPDLOG_INFO("[{}] KEYWORD: Text= {}",stream_sid,  e.Result->Text);
+            SPDLOG_INFO("[{}] KEYWORD: Text= {}",SessionId(),  e.Result->Text);
         }
         else if (e.Result->Reason == ResultReason::RecognizedSpeech)
         {
             // Final result. May differ from the last intermediate result.
-            SPDLOG_INFO("RECOGNIZED: Text= {}", e.Result->Text);
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] RECOGNIZED ({} chars)", SessionId(), e.Result->Text.size());
+            SPDLOG_DEBUG("[{}] RECOGNIZED: Text= {}", SessionId(), e.Result->Text);
             std::string str_copy = e.Result->Text;
             RecognisedText(str_copy);
         }
@@ -73,17 +191,17 @@ void MicrosoftSTT::ImplRecognize() {
             {
             case NoMatchReason::NotRecognized:
                 // Input audio was not silent but contained no recognizable speech.
-                SPDLOG_ERROR("[{}] NO MATCH: Reason= NotRecognized",stream_sid);
+                SPDLOG_ERROR("[{}] NO MATCH: Reason= NotRecognized",SessionId());
                 break;
             case NoMatchReason::InitialSilenceTimeout:
                 // Input audio was silent and the (initial) silence timeout expired.
                 // In continuous recognition this can happen multiple times during
                 // a session, not just at the very beginning.
-                SPDLOG_ERROR("[{}] NO MATCH: Reason= InitialSilenceTimeout",stream_sid);
+                SPDLOG_ERROR("[{}] NO MATCH: Reason= InitialSilenceTimeout",SessionId());
                 break;
             default:
                 // Other reasons are not supported in embedded speech at the moment.
-                SPDLOG_ERROR("[{}] NO MATCH: Other Reason= {} ",stream_sid,int(reason));
+                SPDLOG_ERROR("[{}] NO MATCH: Other Reason= {} ",SessionId(),int(reason));
                 break;
             }
         }
@@ -95,30 +213,37 @@ void MicrosoftSTT::ImplRecognize() {
         {
         case CancellationReason::EndOfStream:
             // Input stream was closed or the end of an input file was reached.
-            SPDLOG_ERROR("[{}] CANCELED: EndOfStream",stream_sid);
+            SPDLOG_ERROR("[{}] CANCELED: EndOfStream",SessionId());
             break;
 
         case CancellationReason::Error:
             // NOTE: In case of an error, do not use the same recognizer for recognition anymore.
-            SPDLOG_ERROR("[{}] CANCELED: ErrorCode= {} ",stream_sid, int(e.ErrorCode));
-            SPDLOG_ERROR("[{}] CANCELED: ErrorDetails= {} ",stream_sid, e.ErrorDetails);
+            SPDLOG_ERROR("[{}] CANCELED: ErrorCode= {} ",SessionId(), int(e.ErrorCode));
+            SPDLOG_ERROR("[{}] CANCELED: ErrorDetails= {} ",SessionId(), e.ErrorDetails);
+            RecognitionEvent(STTEventType::Error, e.ErrorDetails);
             break;
 
         default:
-            SPDLOG_ERROR("[{}] CANCELED: Reason= {} ",stream_sid, int(e.Reason));
+            SPDLOG_ERROR("[{}] CANCELED: Reason= {} ",SessionId(), int(e.Reason));
             break;
         }
     };
 
+    recognizer->SpeechStartDetected += [this](const RecognitionEventArgs& e)
+    {
+        UNUSED(e);
+        RecognitionEvent(STTEventType::SpeechStarted);
+    };
+
     recognizer->SessionStarted += [this](const SessionEventArgs& e)
     {
         UNUSED(e);
-        SPDLOG_INFO("[{}] Session started.",stream_sid);
+        SPDLOG_INFO("[{}] Session started.",SessionId());
     };
 
     recognizer->SessionStopped += [this](const SessionEventArgs& e)
     {
         UNUSED(e);
-        SPDLOG_INFO("[{}] Session stopped.",stream_sid);
+        SPDLOG_INFO("[{}] Session stopped.",SessionId());
     };
 }
@@ -1,30 +1,65 @@
 #include "MicrosoftTTS.h"
 #include <iostream>
 
+// Azure renders raw PCM at these rates natively; anything else is synthesised at 16 kHz and resampled
+SpeechSynthesisOutputFormat MicrosoftTTS::selectOutputFormat() {
+    switch (m_outputSampleRate) {
+    case 8000:
+        m_vendorSampleRate = 8000;
+        return SpeechSynthesisOutputFormat::Raw8Khz16BitMonoPcm;
+    case 24000:
+        m_vendorSampleRate = 24000;
+        return SpeechSynthesisOutputFormat::Raw24Khz16BitMonoPcm;
+    case 48000:
+        m_vendorSampleRate = 48000;
+        return SpeechSynthesisOutputFormat::Raw48Khz16BitMonoPcm;
+    default:
+        m_vendorSampleRate = 16000;
+        return SpeechSynthesisOutputFormat::Raw16Khz16BitMonoPcm;
+    }
+}
+
+MicrosoftTTS::~MicrosoftTTS() {
+    // The synthesizer goes to another session, so this one's thread must be done with it
+    StopSpeak();
+    StopProcessing();
+    AzureSpeech::getInstance().releaseSynthesizer(synthesizer, !synthesizerFailed);
+}
+
 bool MicrosoftTTS::Initialise(const std::string& apiKey, const std::string& region) {
-    // Create speech configuration
-    speechConfig = SpeechConfig::FromSubscription(apiKey, region);
-    speechConfig->SetSpeechSynthesisVoiceName(m_voiceName);
-    speechConfig->SetSpeechSynthesisOutputFormat(SpeechSynthesisOutputFormat::Raw8Khz16BitMonoPcm);
-    synthesizer = SpeechSynthesizer::FromConfig(speechConfig);
+    if (synthesizer) {
+        AzureSpeech::getInstance().releaseSynthesizer(synthesizer, !synthesizerFailed);
+        synthesizerFailed = false;
+    }
+    // Shared config and a synthesizer whose service connection is already being opened
+    synthesizer = AzureSpeech::getInstance().acquireSynthesizer(apiKey, region, m_voiceName, selectOutputFormat());
+    synthesizer->Synthesizing += [this](const SpeechSynthesisEventArgs& e) {
+        UNUSED(e);
+        AudioChunkReceived();
+    };
     return true;
 }
 
 void MicrosoftTTS::ImplSynthesiseVoice(const std::string& text, const std::string& hashKey) {
+    if (IsSynthesisCancelled()) {
+        return;
+    }
+
     auto startTime = std::chrono::high_resolution_clock::now();
     auto result = synthesizer->SpeakTextAsync(text).get();
     
     if (result->Reason == ResultReason::SynthesizingAudioStarted) {
-        SPDLOG_INFO( "[{}] TTS SynthesizingAudioStarted",stream_sid);
+        VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] TTS SynthesizingAudioStarted", stream_sid);
     }   
     else if (result->Reason == ResultReason::SynthesizingAudio) {
-        SPDLOG_INFO( "[{}] TTS SynthesizingAudio",stream_sid);
+        VOICEKIT_LOG_FRAME("[{}] TTS SynthesizingAudio", stream_sid);
     }
     else if (result->Reason == ResultReason::SynthesizingAudioCompleted) {
         auto endTime = std::chrono::high_resolution_clock::now();
         auto ttsLatency = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
-        SPDLOG_INFO( "[{}] TTS SynthesizingAudioCompleted Latency: {} ms for text: {}" ,stream_sid, ttsLatency, text);
+        VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] TTS SynthesizingAudioCompleted Latency: {} ms for {} chars", stream_sid, ttsLatency, text.size());
+        SPDLOG_DEBUG("[{}] Synthesised text: {}", stream_sid, text);
 
         // Get the audio data stream
         auto audioDataStream = AudioDataStream::FromResult(result);
@@ -45,14 +80,24 @@ void MicrosoftTTS::ImplSynthesiseVoice(const std::string& text, const std::strin
         
         SynthesisedAudioData(audioBuffer,hashKey,ttsLatency);
     } 
+    else if (result->Reason == ResultReason::Canceled && IsSynthesisCancelled()) {
+        SPDLOG_INFO( "[{}] Synthesis cancelled",stream_sid );
+    }
     else if (result->Reason == ResultReason::Canceled) {
         auto cancellation = SpeechSynthesisCancellationDetails::FromResult(result);
         SPDLOG_ERROR( "[{}] Synthesis CANCELED: Reason= {}",stream_sid , static_cast<int>(cancellation->Reason) );
 
         if (cancellation->Reason == CancellationReason::Error) {
+            synthesizerFailed = true;
             SPDLOG_ERROR( "[{}] ErrorCode= {}",stream_sid , static_cast<int>(cancellation->ErrorCode) );
             SPDLOG_ERROR( "[{}] ErrorDetails= {}",stream_sid , cancellation->ErrorDetails );
         }
     }    
 
 }
+
+void MicrosoftTTS::ImplCancelSynthesis() {
+    if (synthesizer) {
+        synthesizer->StopSpeakingAsync().get();
+    }
+}
@@ -0,0 +1,316 @@
+#include "ModulePool.h"
+#include "STTFactory.h"
+#include "TTSFactory.h"
+
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace {
+
+// A returned module that has not gone idle by then is destroyed instead of reused
+constexpr auto kReturnTimeout = std::chrono::seconds(10);
+// Wait before retrying a pool whose last module failed to initialise
+constexpr auto kBuildRetryDelay = std::chrono::seconds(5);
+
+std::string poolKey(const std::string& provider, const std::string& variant) {
+    return provider + "/" + variant;
+}
+
+} // namespace
+
+ModulePool& ModulePool::getInstance() {
+    static ModulePool instance;
+    return instance;
+}
+
+ModulePool::~ModulePool() {
+    shutdown();
+}
+
+void ModulePool::addTTSPool(const TTSPoolSpec& spec) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (shutDown) {
+        SPDLOG_WARN("ModulePool is shut down, ignoring TTS pool {}", poolKey(spec.provider, spec.voiceName));
+        return;
+    }
+    auto& pool = ttsPools[poolKey(spec.provider, spec.voiceName)];
+    pool.spec = spec;
+    pool.retryAfter = {};
+    ensureThread();
+    maintainCV.notify_one();
+}
+
+void ModulePool::addSTTPool(const STTPoolSpec& spec) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (shutDown) {
+        SPDLOG_WARN("ModulePool is shut down, ignoring STT pool {}", poolKey(spec.provider, spec.config.language));
+        return;
+    }
+    auto& pool = sttPools[poolKey(spec.provider, spec.config.language)];
+    pool.spec = spec;
+    pool.retryAfter = {};
+    ensureThread();
+    maintainCV.notify_one();
+}
+
+void ModulePool::ensureThread() {
+    if (!maintenanceThread.joinable()) {
+        maintenanceThread = std::thread(&ModulePool::maintain, this);
+    }
+}
+
+std::shared_ptr<TTSModuleBase> ModulePool::buildTTS(const TTSPoolSpec& spec) {
+    std::string sid = "pool-" + spec.provider + "-" + std::to_string(++serial);
+    auto module = std::dynamic_pointer_cast<TTSModuleBase>(
+        TTSFactory::CreateTTSModule(spec.provider, sid, [](const std::vector<uint8_t>&) {}, spec.voiceName));
+    if (!module) {
+        throw std::runtime_error("TTS provider " + spec.provider + " cannot be pooled: not a TTSModuleBase");
+    }
+    module->SetOutputSampleRate(spec.outputSampleRate);
+    if (!module->Initialise(spec.apiKey, spec.region)) {
+        throw std::runtime_error("Failed to initialise pooled TTS " + poolKey(spec.provider, spec.voiceName));
+    }
+    return module;
+}
+
+std::shared_ptr<STTModuleBase> ModulePool::buildSTT(const STTPoolSpec& spec) {
+    std::string sid = "pool-" + spec.provider + "-" + std::to_string(++serial);
+    auto module = std::dynamic_pointer_cast<STTModuleBase>(
+        STTFactory::CreateSTTModule(spec.provider, sid, [](std::string&) {}, spec.config.language));
+    if (!module) {
+        throw std::runtime_error("STT provider " + spec.provider + " cannot be pooled: not an STTModuleBase");
+    }
+    module->Configure(spec.config);
+    module->InitialiseSTTModule(spec.config.apiKey, spec.config.region);
+    return module;
+}
+
+std::shared_ptr<I_TTSModule> ModulePool::leaseTTS(const std::string& provider, const std::string& voiceName,
+                                                  const std::string& sid,
+                                                  std::function<void(const std::vector<uint8_t>&)> callback) {
+    std::string key = poolKey(provider, voiceName);
+    std::shared_ptr<TTSModuleBase> module;
+    TTSPoolSpec spec;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ttsPools.find(key);
+        if (it == ttsPools.end()) throw std::runtime_error("No TTS pool for " + key);
+        spec = it->second.spec;
+        if (!it->second.idle.empty()) {
+            module = std::move(it->second.idle.front());
+            it->second.idle.pop_front();
+            ++stats.warmLeases;
+        } else {
+            ++stats.coldLeases;
+        }
+    }
+    maintainCV.notify_one();
+
+    if (!module) module = buildTTS(spec);
+    if (!module->Rebind(sid, std::move(callback))) throw std::runtime_error("Pooled TTS module is busy");
+    return std::shared_ptr<I_TTSModule>(module.get(), [this, module, key](I_TTSModule*) {
+        module->ResetForReuse();
+        giveBack({module, nullptr, key, std::chrono::steady_clock::now()});
+    });
+}
+
+std::shared_ptr<I_STTModule> ModulePool::leaseSTT(const std::string& provider, const std::string& language,
+                                                  const std::string& sid, std::function<void(std::string&)> callback) {
+    std::string key = poolKey(provider, language);
+    std::shared_ptr<STTModuleBase> module;
+    STTPoolSpec spec;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = sttPools.find(key);
+        if (it == sttPools.end()) throw std::runtime_error("No STT pool for " + key);
+        spec = it->second.spec;
+        if (!it->second.idle.empty()) {
+            module = std::move(it->second.idle.front());
+            it->second.idle.pop_front();
+            ++stats.warmLeases;
+        } else {
+            ++stats.coldLeases;
+        }
+    }
+    maintainCV.notify_one();
+
+    if (!module) module = buildSTT(spec);
+    if (!module->Rebind(sid, std::move(callback))) throw std::runtime_error("Pooled STT module is busy");
+    return std::shared_ptr<I_STTModule>(module.get(), [this, module, key](I_STTModule*) {
+        module->ResetForReuse();
+        giveBack({nullptr, module, key, std::chrono::steady_clock::now()});
+    });
+}
+
+void ModulePool::giveBack(Returning module) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!shutDown) {
+            returning.push_back(std::move(module));
+            maintainCV.notify_one();
+            return;
+        }
+    }
+    // Shut down: `module` is destroyed here, outside the lock
+}
+
+bool ModulePool::drainReturning() {
+    std::vector<Returning> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(returning);
+    }
+    if (pending.empty()) return false;
+
+    std::vector<Returning> waiting;
+    std::vector<Returning> destroy;  // destroyed after the lock is released
+    bool progressed = false;
+    auto now = std::chrono::steady_clock::now();
+    for (auto& module : pending) {
+        bool idle = module.tts ? module.tts->IsIdle() : module.stt->IsIdle();
+        if (!idle) {
+            if (now - module.since < kReturnTimeout) {
+                waiting.push_back(std::move(module));
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.discarded;
+            destroy.push_back(std::move(module));
+            progressed = true;
+            continue;
+        }
+
+        // Drop the last session's callback and id before parking the module
+        std::string sid = "pool-idle-" + std::to_string(++serial);
+        if (module.tts) module.tts->Rebind(sid, [](const std::vector<uint8_t>&) {});
+        if (module.stt) module.stt->Rebind(sid, [](std::string&) {});
+
+        std::lock_guard<std::mutex> lock(mutex);
+        progressed = true;
+        if (module.tts) {
+            auto it = ttsPools.find(module.key);
+            if (it != ttsPools.end() && it->second.idle.size() < it->second.spec.maxIdle) {
+                it->second.idle.push_back(std::move(module.tts));
+                ++stats.returned;
+                continue;
+            }
+        } else {
+            auto it = sttPools.find(module.key);
+            if (it != sttPools.end() && it->second.idle.size() < it->second.spec.maxIdle) {
+                it->second.idle.push_back(std::move(module.stt));
+                ++stats.returned;
+                continue;
+            }
+        }
+        ++stats.discarded;
+        destroy.push_back(std::move(module));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& module : waiting) returning.push_back(std::move(module));
+    return progressed;
+}
+
+bool ModulePool::refillOnce() {
+    auto now = std::chrono::steady_clock::now();
+    std::string key;
+    bool tts = false;
+    TTSPoolSpec ttsSpec;
+    STTPoolSpec sttSpec;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Modules still draining after a session count towards `warm`; they are about to go idle
+        std::map<std::string, size_t> draining;
+        for (const auto& module : returning) ++draining[module.key];
+        auto needs = [&](const std::string& poolName, const auto& pool) {
+            auto it = draining.find(poolName);
+            size_t ready = pool.idle.size() + pool.building + (it == draining.end() ? 0 : it->second);
+            return ready < pool.spec.warm && pool.retryAfter <= now;
+        };
+        for (auto& [poolName, pool] : ttsPools) {
+            if (needs(poolName, pool)) {
+                key = poolName;
+                tts = true;
+                ttsSpec = pool.spec;
+                ++pool.building;
+                break;
+            }
+        }
+        if (key.empty()) {
+            for (auto& [poolName, pool] : sttPools) {
+                if (needs(poolName, pool)) {
+                    key = poolName;
+                    sttSpec = pool.spec;
+                    ++pool.building;
+                    break;
+                }
+            }
+        }
+    }
+    if (key.empty()) return false;
+
+    std::shared_ptr<TTSModuleBase> ttsModule;
+    std::shared_ptr<STTModuleBase> sttModule;
+    try {
+        if (tts) ttsModule = buildTTS(ttsSpec);
+        else sttModule = buildSTT(sttSpec);
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("ModulePool failed to build {}: {}", key, e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto finish = [&](auto& pools, auto& module) {
+        auto it = pools.find(key);
+        if (it == pools.end()) return;  // replaced by shutdown()
+        --it->second.building;
+        if (!module) {
+            ++stats.discarded;
+            it->second.retryAfter = std::chrono::steady_clock::now() + kBuildRetryDelay;
+            return;
+        }
+        it->second.idle.push_back(std::move(module));
+    };
+    if (tts) finish(ttsPools, ttsModule);
+    else finish(sttPools, sttModule);
+    return true;
+}
+
+void ModulePool::maintain() {
+    pthread_setname_np(pthread_self(), "ModulePool");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopMaintenance) {
+        lock.unlock();
+        bool worked = drainReturning();
+        worked = refillOnce() || worked;
+        lock.lock();
+        if (worked) continue;
+        // Returned modules are polled until their cancelled work drains
+        auto interval = returning.empty() ? std::chrono::milliseconds(1000) : std::chrono::milliseconds(20);
+        maintainCV.wait_for(lock, interval);
+    }
+}
+
+ModulePool::Stats ModulePool::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats snapshot = stats;
+    for (const auto& entry : ttsPools) snapshot.idle += entry.second.idle.size();
+    for (const auto& entry : sttPools) snapshot.idle += entry.second.idle.size();
+    return snapshot;
+}
+
+void ModulePool::shutdown() {
+    std::map<std::string, Pool<TTSModuleBase, TTSPoolSpec>> ttsModules;
+    std::map<std::string, Pool<STTModuleBase, STTPoolSpec>> sttModules;
+    std::vector<Returning> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shutDown = true;
+        stopMaintenance = true;
+        ttsModules.swap(ttsPools);
+        sttModules.swap(sttPools);
+        pending.swap(returning);
+    }
+    maintainCV.notify_all();
+    if (maintenanceThread.joinable()) maintenanceThread.join();
+    // Modules are destroyed here, outside the lock
+}
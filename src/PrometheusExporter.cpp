@@ -0,0 +1,281 @@
+#include "PrometheusExporter.h"
+#include "Logging.h"
+#include "TTSCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+const std::array<double, PrometheusExporter::bucketCount - 1> PrometheusExporter::bucketBoundsSeconds = {
+    0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+
+namespace {
+
+const Metric kAllMetrics[] = {Metric::TTSQueueWait, Metric::TTSTimeToFirstAudio, Metric::TTSSynthesisTime,
+                              Metric::TTSCachedPlayoutStart, Metric::TTSPlayoutUnderrun, Metric::STTQueueWait,
+                              Metric::STTFinalResult, Metric::BargeInReaction};
+
+const char* metricHelp(Metric metric) {
+    switch (metric) {
+    case Metric::TTSQueueWait: return "Time from Speak() until the text is picked up for synthesis.";
+    case Metric::TTSTimeToFirstAudio: return "Time from the vendor request until its first audio chunk.";
+    case Metric::TTSSynthesisTime: return "Time from the vendor request until the complete audio.";
+    case Metric::TTSCachedPlayoutStart: return "Time from segment start until the first chunk plays, for cache hits.";
+    case Metric::TTSPlayoutUnderrun: return "Audio chunks delivered more than a frame late during speech.";
+    case Metric::STTQueueWait: return "Time from StreamAudioData() until the audio reaches the vendor.";
+    case Metric::STTFinalResult: return "Final transcripts received.";
+    case Metric::BargeInReaction: return "Time from detected caller speech until TTS playout was stopped.";
+    }
+    return "";
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+// `labels` is either empty or `key="value",...` without braces
+std::string withLabels(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return "";
+    if (labels.empty()) return "{" + extra + "}";
+    if (extra.empty()) return "{" + labels + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+void appendLine(std::string& out, const std::string& name, const std::string& labels, double value) {
+    out += name;
+    out += labels;
+    out.push_back(' ');
+    out += formatNumber(value);
+    out.push_back('\n');
+}
+
+void appendHeader(std::string& out, const std::string& name, const char* type, const char* help) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+void appendLookupHistogram(std::string& out, const std::string& name, const std::string& tier,
+                           const LatencyHistogram::Snapshot& snapshot) {
+    std::string tierLabel = "tier=\"" + tier + "\"";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::bucketCount; ++i) {
+        cumulative += snapshot.counts[i];
+        std::string le = snapshot.upperBoundsNanos[i] ? formatNumber(snapshot.upperBoundsNanos[i] / 1e9) : "+Inf";
+        appendLine(out, name + "_bucket", withLabels(tierLabel, "le=\"" + le + "\""), cumulative);
+    }
+    appendLine(out, name + "_sum", withLabels(tierLabel), snapshot.sumNanos / 1e9);
+    appendLine(out, name + "_count", withLabels(tierLabel), snapshot.count);
+}
+
+} // namespace
+
+PrometheusExporter::PrometheusExporter() : PrometheusExporter(Options()) {}
+
+PrometheusExporter::PrometheusExporter(const Options& options) : m_options(options) {}
+
+PrometheusExporter::~PrometheusExporter() {
+    Stop();
+}
+
+std::string PrometheusExporter::labelText(const MetricLabels& labels) const {
+    std::string text = "vendor=\"" + escapeLabel(labels.vendor) + "\",voice=\"" + escapeLabel(labels.voice) + "\"";
+    if (m_options.sessionLabel) text += ",session=\"" + escapeLabel(labels.session) + "\"";
+    return text;
+}
+
+void PrometheusExporter::LabelSeries::RecordLatency(Metric metric, double milliseconds) {
+    double seconds = milliseconds / 1000.0;
+    size_t bucket = 0;
+    while (bucket < bucketBoundsSeconds.size() && seconds > bucketBoundsSeconds[bucket]) ++bucket;
+
+    Cells& entry = cells[static_cast<size_t>(metric)];
+    entry.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    entry.sumNanos.fetch_add(static_cast<uint64_t>(std::llround(std::max(milliseconds, 0.0) * 1e6)), std::memory_order_relaxed);
+    if (!entry.used.load(std::memory_order_relaxed)) entry.used.store(true, std::memory_order_relaxed);
+}
+
+void PrometheusExporter::LabelSeries::IncrementCounter(Metric metric, uint64_t delta) {
+    Cells& entry = cells[static_cast<size_t>(metric)];
+    entry.counter.fetch_add(delta, std::memory_order_relaxed);
+    if (!entry.used.load(std::memory_order_relaxed)) entry.used.store(true, std::memory_order_relaxed);
+}
+
+std::shared_ptr<PrometheusExporter::LabelSeries> PrometheusExporter::findSeries(const MetricLabels& labels) {
+    std::string key = labelText(labels);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = series[std::move(key)];
+    if (!entry) entry = std::make_shared<LabelSeries>();
+    return entry;
+}
+
+std::shared_ptr<I_MetricsSink::Series> PrometheusExporter::Resolve(const MetricLabels& labels) {
+    return findSeries(labels);
+}
+
+void PrometheusExporter::RecordLatency(Metric metric, const MetricLabels& labels, double milliseconds) {
+    findSeries(labels)->RecordLatency(metric, milliseconds);
+}
+
+void PrometheusExporter::IncrementCounter(Metric metric, const MetricLabels& labels, uint64_t delta) {
+    findSeries(labels)->IncrementCounter(metric, delta);
+}
+
+std::string PrometheusExporter::Render() {
+    std::vector<std::pair<std::string, std::shared_ptr<LabelSeries>>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.assign(series.begin(), series.end());
+    }
+
+    std::string out;
+    for (Metric metric : kAllMetrics) {
+        bool counter = IsCounterMetric(metric);
+        std::string name = std::string(MetricName(metric)) + (counter ? "_total" : "_seconds");
+        bool headerWritten = false;
+        for (const auto& [labels, labelSeries] : snapshot) {
+            const Cells& entry = labelSeries->cells[static_cast<size_t>(metric)];
+            if (!entry.used.load(std::memory_order_relaxed)) continue;
+            if (!headerWritten) {
+                appendHeader(out, name, counter ? "counter" : "histogram", metricHelp(metric));
+                headerWritten = true;
+            }
+            if (counter) {
+                appendLine(out, name, withLabels(labels), entry.counter.load(std::memory_order_relaxed));
+                continue;
+            }
+            // _count is the +Inf bucket, so the two agree even while recording continues
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < bucketCount; ++i) {
+                cumulative += entry.buckets[i].load(std::memory_order_relaxed);
+                std::string le = i < bucketBoundsSeconds.size() ? formatNumber(bucketBoundsSeconds[i]) : "+Inf";
+                appendLine(out, name + "_bucket", withLabels(labels, "le=\"" + le + "\""), cumulative);
+            }
+            appendLine(out, name + "_sum", withLabels(labels), entry.sumNanos.load(std::memory_order_relaxed) / 1e9);
+            appendLine(out, name + "_count", withLabels(labels), cumulative);
+        }
+    }
+
+    appendHeader(out, "voicekit_log_suppressed_total", "counter", "Log messages dropped by per-session rate limits.");
+    appendLine(out, "voicekit_log_suppressed_total", "", Logging::suppressedMessages());
+    appendHeader(out, "voicekit_log_dropped_total", "counter", "Log messages discarded by a full async log queue.");
+    appendLine(out, "voicekit_log_dropped_total", "", Logging::droppedMessages());
+
+    if (m_options.includeCacheStats) {
+        out += RenderCacheStats(TTSCache::getInstance().getStats());
+    }
+    return out;
+}
+
+std::string PrometheusExporter::RenderCacheStats(const TTSCacheStats& stats) {
+    std::string out;
+
+    appendHeader(out, "voicekit_ttscache_hits_total", "counter", "TTS cache lookups answered, by tier.");
+    appendLine(out, "voicekit_ttscache_hits_total", "{tier=\"memory\"}", stats.memoryHits);
+    appendLine(out, "voicekit_ttscache_hits_total", "{tier=\"shared\"}", stats.sharedHits);
+    appendLine(out, "voicekit_ttscache_hits_total", "{tier=\"disk\"}", stats.diskHits);
+    appendHeader(out, "voicekit_ttscache_misses_total", "counter", "TTS cache lookups that fell through a tier.");
+    appendLine(out, "voicekit_ttscache_misses_total", "{tier=\"memory\"}", stats.memoryMisses);
+    appendLine(out, "voicekit_ttscache_misses_total", "{tier=\"shared\"}", stats.sharedMisses);
+    appendLine(out, "voicekit_ttscache_misses_total", "{tier=\"disk\"}", stats.diskMisses);
+
+    appendHeader(out, "voicekit_ttscache_entries", "gauge", "Entries held, by tier.");
+    appendLine(out, "voicekit_ttscache_entries", "{tier=\"memory\"}", stats.memoryEntries);
+    appendLine(out, "voicekit_ttscache_entries", "{tier=\"disk\"}", stats.diskEntries);
+    appendHeader(out, "voicekit_ttscache_bytes", "gauge", "Bytes held, by tier.");
+    appendLine(out, "voicekit_ttscache_bytes", "{tier=\"memory\"}", stats.memoryResidentBytes);
+    appendLine(out, "voicekit_ttscache_bytes", "{tier=\"disk\"}", stats.diskTotalBytes);
+    appendLine(out, "voicekit_ttscache_bytes", "{tier=\"disk_live\"}", stats.diskLiveBytes);
+    appendHeader(out, "voicekit_ttscache_evictions_total", "counter", "Entries evicted, by tier.");
+    appendLine(out, "voicekit_ttscache_evictions_total", "{tier=\"memory\"}", stats.memoryEvictions);
+    appendLine(out, "voicekit_ttscache_evictions_total", "{tier=\"disk\"}", stats.diskEvictedEntries);
+
+    appendHeader(out, "voicekit_ttscache_write_queue_bytes", "gauge", "Audio bytes waiting for the disk writer.");
+    appendLine(out, "voicekit_ttscache_write_queue_bytes", "", stats.writeQueueBytes);
+    appendHeader(out, "voicekit_ttscache_writes_total", "counter", "Disk tier writes, by result.");
+    appendLine(out, "voicekit_ttscache_writes_total", "{result=\"completed\"}", stats.writesCompleted);
+    appendLine(out, "voicekit_ttscache_writes_total", "{result=\"coalesced\"}", stats.writesCoalesced);
+    appendLine(out, "voicekit_ttscache_writes_total", "{result=\"dropped\"}", stats.writesDropped);
+    appendLine(out, "voicekit_ttscache_writes_total", "{result=\"error\"}", stats.writeErrors);
+
+    appendHeader(out, "voicekit_ttscache_lookup_seconds", "histogram", "TTS cache lookup latency, by tier reached.");
+    appendLookupHistogram(out, "voicekit_ttscache_lookup_seconds", "memory", stats.memoryLookupLatency);
+    appendLookupHistogram(out, "voicekit_ttscache_lookup_seconds", "shared", stats.sharedLookupLatency);
+    appendLookupHistogram(out, "voicekit_ttscache_lookup_seconds", "disk", stats.diskLookupLatency);
+
+    if (!stats.labels.empty()) {
+        appendHeader(out, "voicekit_ttscache_label_lookups_total", "counter", "TTS cache lookups per vendor/voice.");
+        for (const auto& [label, counts] : stats.labels) {
+            std::string key = "label=\"" + escapeLabel(label) + "\"";
+            appendLine(out, "voicekit_ttscache_label_lookups_total", withLabels(key, "result=\"hit\""), counts.hits);
+            appendLine(out, "voicekit_ttscache_label_lookups_total", withLabels(key, "result=\"miss\""), counts.misses);
+        }
+    }
+    return out;
+}
+
+bool PrometheusExporter::WriteFile(const std::string& path) {
+    std::string text = Render();
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            SPDLOG_ERROR("Failed to write metrics to {}", temporary);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        SPDLOG_ERROR("Failed to publish metrics to {}: {}", path, ec.message());
+        return false;
+    }
+    return true;
+}
+
+void PrometheusExporter::StartPeriodic(std::chrono::milliseconds interval,
+                                       std::function<void(const std::string&)> output) {
+    Stop();
+    {
+        std::lock_guard<std::mutex> lock(periodicMutex);
+        stopPeriodic = false;
+    }
+    periodicThread = std::thread([this, interval, output = std::move(output)] {
+        pthread_setname_np(pthread_self(), "MetricsExport");
+        std::unique_lock<std::mutex> lock(periodicMutex);
+        while (!periodicCV.wait_for(lock, interval, [this] { return stopPeriodic; })) {
+            lock.unlock();
+            output(Render());
+            lock.lock();
+        }
+    });
+}
+
+void PrometheusExporter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(periodicMutex);
+        stopPeriodic = true;
+    }
+    periodicCV.notify_all();
+    if (periodicThread.joinable()) periodicThread.join();
+}
@@ -1,13 +1,52 @@
 #include "STTFactory.h"
 #include "MicrosoftSTT.h"
 #include "DeepgramSTT.h"
+#include "ModulePool.h"
+
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex registryMutex;
+
+std::map<std::string, STTFactory::Creator>& registry() {
+    static std::map<std::string, STTFactory::Creator> providers = {
+        {"Microsoft", [](const std::string& sid, std::function<void(std::string&)> callback, std::string language) {
+             return std::make_shared<MicrosoftSTT>(sid, callback, language);
+         }},
+        {"Deepgram", [](const std::string& sid, std::function<void(std::string&)> callback, std::string language) {
+             return std::make_shared<DeepgramSTT>(sid, callback, language);
+         }},
+    };
+    return providers;
+}
+
+} // namespace
 
 std::shared_ptr<I_STTModule> STTFactory::CreateSTTModule(const std::string& provider, const std::string& stream_sid, std::function<void(std::string&)> callback, std::string language) {
-    if (provider == "Microsoft") {
-        return std::make_shared<MicrosoftSTT>(stream_sid, callback, language);
-    } else if (provider == "Deepgram") {
-        return std::make_shared<DeepgramSTT>(stream_sid, callback, language);
+    Creator creator;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = registry().find(provider);
+        if (it != registry().end()) creator = it->second;
     }
-    // Add other providers here
-    throw std::runtime_error("Unsupported STT provider");
+    if (!creator) throw std::runtime_error("Unsupported STT provider");
+    return creator(stream_sid, callback, language);
+}
+
+std::shared_ptr<I_STTModule> STTFactory::LeaseSTTModule(const std::string& provider, const std::string& stream_sid, std::function<void(std::string&)> callback, std::string language) {
+    return ModulePool::getInstance().leaseSTT(provider, language, stream_sid, callback);
+}
+
+void STTFactory::RegisterProvider(const std::string& provider, Creator creator) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry()[provider] = std::move(creator);
+}
+
+std::vector<std::string> STTFactory::Providers() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<std::string> names;
+    for (const auto& entry : registry()) names.push_back(entry.first);
+    return names;
 }
@@ -1,24 +1,152 @@
 #include "STTModuleBase.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 STTModuleBase::STTModuleBase(const std::string& sid, std::function<void(std::string&)> cb, std::string lang)
     : stream_sid(sid), callback(cb), language(lang), processingThread(&STTModuleBase::ProcessAudioStream, this) {}
 
 STTModuleBase::~STTModuleBase() {
-    stopProcessing = true;
+    StopProcessing();
+    ResolveUtterances("");
+}
+
+void STTModuleBase::StopProcessing() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopProcessing = true;
+    }
     queueCV.notify_all();
     if (processingThread.joinable()) processingThread.join();
 }
 
+void STTModuleBase::SetEventCallback(std::function<void(const STTEvent&)> callback) {
+    std::lock_guard<std::mutex> lock(eventMutex);
+    eventCallback = std::move(callback);
+}
+
+void STTModuleBase::RecognitionEvent(STTEventType type, const std::string& detail) {
+    // Only once the vendor has stopped, so final transcripts it flushes while stopping still count
+    if (type == STTEventType::RecognitionStopped) ResolveUtterances("");
+    std::function<void(const STTEvent&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex);
+        callback = eventCallback;
+    }
+    if (callback) callback(STTEvent{type, detail});
+}
+
 void STTModuleBase::RecognisedText(std::string& text) {
-    if (!stopProcessing){
-        callback(text);
+    m_metrics.incrementCounter(Metric::STTFinalResult);
+    // Vendors call this from their own threads; Rebind() may be swapping the callback
+    std::function<void(std::string&)> sessionCallback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        sessionCallback = callback;
+    }
+    if (!stopProcessing && sessionCallback){
+        sessionCallback(text);
+    }
+    ResolveUtterances(text);
+}
+
+void STTModuleBase::RecognisedSegment(std::string& text, double startMs, double endMs) {
+    if (m_bulkActive) {
+        std::lock_guard<std::mutex> lock(bulkMutex);
+        m_bulkSegments.push_back({startMs, endMs, text});
+    }
+    RecognisedText(text);
+}
+
+void STTModuleBase::ImplBeginBulk() {
+    throw std::runtime_error(std::string(VendorName()) + " STT has no bulk transcription mode");
+}
+
+std::vector<TranscriptSegment> STTModuleBase::TranscribeAudio(const uint8_t* audio, size_t size) {
+    return TranscribeAudio(audio, size, BulkOptions());
+}
+
+std::vector<TranscriptSegment> STTModuleBase::TranscribeAudio(const uint8_t* audio, size_t size,
+                                                              const BulkOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (m_recognitionStarted || m_bulkActive) {
+            throw std::runtime_error("Bulk transcription needs a module that is not already recognising");
+        }
+        m_bulkActive = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(bulkMutex);
+        m_bulkSegments.clear();
+    }
+    m_bulkOptions = options;
+    auto started = std::chrono::steady_clock::now();
+
+    try {
+        ImplBeginBulk();
+        std::unique_ptr<AudioResampler> resampler;
+        int inputRate = m_inputSampleRate;
+        int vendorRate = m_vendorSampleRate;
+        if (inputRate != vendorRate) {
+            resampler = std::make_unique<AudioResampler>(inputRate, vendorRate);
+        }
+        size_t frameBytes = std::max<size_t>(2, static_cast<size_t>(options.frameMs) * inputRate / 1000 * 2);
+        for (size_t offset = 0; offset < size; offset += frameBytes) {
+            size_t length = std::min(frameBytes, size - offset);
+            if (resampler) {
+                std::vector<uint8_t> converted = resampler->process(audio + offset, length);
+                ImplStreamBulk(converted.data(), converted.size());
+            } else {
+                ImplStreamBulk(audio + offset, length);
+            }
+        }
+        ImplEndBulk();
+    } catch (...) {
+        try {
+            ImplAbortBulk();
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("[{}] Failed to abort bulk transcription: {}", SessionId(), e.what());
+        }
+        m_bulkActive = false;
+        throw;
+    }
+
+    std::vector<TranscriptSegment> segments;
+    {
+        std::lock_guard<std::mutex> lock(bulkMutex);
+        segments.swap(m_bulkSegments);
+    }
+    m_bulkActive = false;
+    std::stable_sort(segments.begin(), segments.end(),
+                     [](const TranscriptSegment& a, const TranscriptSegment& b) { return a.startMs < b.startMs; });
+
+    double audioMs = 1000.0 * (size / 2) / m_inputSampleRate;
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    SPDLOG_INFO("[{}] Bulk transcription: {:.1f} s of audio in {:.1f} s ({:.1f}x real time), {} segments", SessionId(),
+                audioMs / 1000, elapsedMs / 1000, elapsedMs > 0 ? audioMs / elapsedMs : 0.0, segments.size());
+    return segments;
+}
+
+void STTModuleBase::ResolveUtterances(const std::string& text) {
+    std::vector<Completion<std::string>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(utteranceMutex);
+        waiting.swap(pendingUtterances);
     }
+    for (auto& utterance : waiting) utterance.resolve(text);
+}
+
+Completion<std::string> STTModuleBase::NextUtterance() {
+    Completion<std::string> utterance;
+    std::lock_guard<std::mutex> lock(utteranceMutex);
+    pendingUtterances.push_back(utterance);
+    return utterance;
 }
 
 void STTModuleBase::ProcessAudioStream() {
     pthread_setname_np(pthread_self(), "STTModuleBaseThread");
     while (!stopProcessing) {
-        std::tuple<std::string, std::function<void(std::string&)>,std::vector<uint8_t>> task;
+        std::tuple<std::string, std::function<void(std::string&)>,std::vector<uint8_t>,std::chrono::steady_clock::time_point> task;
         {
             std::unique_lock<std::mutex> lock(queueMutex);
             queueCV.wait(lock, [this] { return stopProcessing || !audioQueue.empty(); });
@@ -27,7 +155,7 @@ void STTModuleBase::ProcessAudioStream() {
                 while (!audioQueue.empty()) {
                     audioQueue.pop();
                 }
-                SPDLOG_INFO("[{}] Stopping recognise thread.",stream_sid);
+                SPDLOG_INFO("[{}] Stopping recognise thread.", SessionId());
                 return; // Exit thread
             }
             
@@ -36,6 +164,7 @@ void STTModuleBase::ProcessAudioStream() {
             }
             task = std::move(audioQueue.front());
             audioQueue.pop();
+            m_busy = true;
         }
 
         std::string taskType = std::get<0>(task);
@@ -44,42 +173,98 @@ void STTModuleBase::ProcessAudioStream() {
 
         try{
             if (taskType == "media") {
+                m_metrics.recordLatency(Metric::STTQueueWait, std::get<3>(task));
+                int inputRate = m_inputSampleRate;
+                int vendorRate = m_vendorSampleRate;
+                if (inputRate != vendorRate) {
+                    if (!m_inputResampler || m_inputResampler->inputRate() != inputRate ||
+                        m_inputResampler->outputRate() != vendorRate) {
+                        m_inputResampler = std::make_unique<AudioResampler>(inputRate, vendorRate);
+                    }
+                    audioData = m_inputResampler->process(audioData.data(), audioData.size());
+                }
                 ImplStreamAudioData(audioData);
             }else if (taskType == "start"){
-                SPDLOG_INFO("[{}] Start RecognizeSpeech.",stream_sid);
+                SPDLOG_INFO("[{}] Start RecognizeSpeech.", SessionId());
+                m_inputResampler.reset();
                 ImplStartRecognition();
+                if (!m_asyncStartStop) RecognitionEvent(STTEventType::RecognitionStarted);
             }else if (taskType == "stop"){
-                SPDLOG_INFO("[{}] Stop RecognizeSpeech.",stream_sid);
+                SPDLOG_INFO("[{}] Stop RecognizeSpeech.", SessionId());
                 ImplStopRecognition();
+                if (!m_asyncStartStop) RecognitionEvent(STTEventType::RecognitionStopped);
             }
         } catch (const std::exception &e) {
             SPDLOG_ERROR( "{}" , e.what() );
+            if (taskType != "media") RecognitionEvent(STTEventType::Error, e.what());
         }
+        std::lock_guard<std::mutex> lock(queueMutex);
+        m_busy = false;
     }
 }
 
+void STTModuleBase::Configure(const STTConfig& config) {
+    if (config.sampleRate <= 0) {
+        throw std::invalid_argument("Invalid STT sample rate " + std::to_string(config.sampleRate));
+    }
+    m_inputSampleRate = config.sampleRate;
+    m_vendorSampleRate = config.sampleRate;
+}
+
 void STTModuleBase::StreamAudioData(std::vector<uint8_t> audioData) {
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        audioQueue.push({"media", callback, audioData});
+        audioQueue.push({"media", callback, audioData, std::chrono::steady_clock::now()});
     }
     queueCV.notify_one();
 }
 
 void STTModuleBase::StartRecognition() {
+    m_recognitionStarted = true;
     {
         std::vector<uint8_t> audioData;
         std::lock_guard<std::mutex> lock(queueMutex);
-        audioQueue.push({"start", callback, audioData});
+        audioQueue.push({"start", callback, audioData, std::chrono::steady_clock::now()});
     }
     queueCV.notify_one();
 }
 
 void STTModuleBase::StopRecognition() {
+    m_recognitionStarted = false;
     {
         std::vector<uint8_t> audioData;
         std::lock_guard<std::mutex> lock(queueMutex);
-        audioQueue.push({"stop", callback, audioData});
+        audioQueue.push({"stop", callback, audioData, std::chrono::steady_clock::now()});
     }
     queueCV.notify_one();
 }
+
+void STTModuleBase::ResetForReuse() {
+    if (m_recognitionStarted) StopRecognition();
+}
+
+bool STTModuleBase::IsIdle() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return audioQueue.empty() && !m_busy && !m_recognitionStarted && !m_bulkActive && ImplControlSettled();
+}
+
+bool STTModuleBase::Rebind(const std::string& sid, std::function<void(std::string&)> cb) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!audioQueue.empty() || m_busy || m_recognitionStarted || m_bulkActive || !ImplControlSettled()) return false;
+    {
+        std::lock_guard<std::mutex> sessionLock(sessionMutex);
+        stream_sid = sid;
+    }
+    m_metrics.invalidate();
+    {
+        std::lock_guard<std::mutex> callbackLock(callbackMutex);
+        callback = std::move(cb);
+    }
+    SetEventCallback(nullptr);
+    return true;
+}
+
+std::string STTModuleBase::SessionId() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return stream_sid;
+}
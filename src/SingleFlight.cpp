@@ -0,0 +1,76 @@
+#include "SingleFlight.h"
+
+// How often a waiting follower re-checks whether its own session stopped
+static constexpr auto kFollowerPollInterval = std::chrono::milliseconds(100);
+
+SingleFlight& SingleFlight::getInstance() {
+    static SingleFlight instance;
+    return instance;
+}
+
+std::shared_ptr<SingleFlight::Flight> SingleFlight::join(const std::string& key, bool& leader) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = flights.find(key);
+    if (it != flights.end()) {
+        leader = false;
+        followers.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+    leader = true;
+    leaders.fetch_add(1, std::memory_order_relaxed);
+    auto flight = std::make_shared<Flight>();
+    flights.emplace(key, flight);
+    return flight;
+}
+
+void SingleFlight::finish(const std::string& key, const std::shared_ptr<Flight>& flight, bool success) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = flights.find(key);
+        if (it != flights.end() && it->second == flight) {
+            flights.erase(it);
+        }
+    }
+    flight->finish(success);
+}
+
+void SingleFlight::Flight::publish(AudioPtr chunk) {
+    if (!chunk) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.push_back(std::move(chunk));
+    }
+    cv.notify_all();
+}
+
+size_t SingleFlight::Flight::chunkCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size();
+}
+
+void SingleFlight::Flight::finish(bool success) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        succeeded = success;
+    }
+    cv.notify_all();
+}
+
+bool SingleFlight::Flight::follow(const std::function<void(const std::vector<uint8_t>&)>& onChunk,
+                                  const std::function<bool()>& stopped) {
+    size_t next = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait_for(lock, kFollowerPollInterval, [&] { return next < chunks.size() || done; });
+        // Play outside the lock; playout paces itself in real time
+        while (next < chunks.size()) {
+            AudioPtr chunk = chunks[next++];
+            lock.unlock();
+            onChunk(*chunk);
+            lock.lock();
+        }
+        if (done) return succeeded;
+        if (stopped && stopped()) return false;
+    }
+}
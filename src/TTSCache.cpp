@@ -1,5 +1,9 @@
 #include "TTSCache.h"
 
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
 #define CACHE_DIR "./tts_cache/"
 
 // Singleton instance
@@ -8,19 +12,22 @@ TTSCache& TTSCache::getInstance() {
     return instance;
 }
 
-// Constructor ensures cache directory exists and starts worker threads
-TTSCache::TTSCache() : stopThreads(false), threadCount(2) {
+static std::string ensureCacheDir() {
+    const char* configured = std::getenv("VOICEKIT_TTS_CACHE_DIR");
+    std::string directory = (configured && *configured) ? configured : CACHE_DIR;
     try {
-        if (!std::filesystem::exists(CACHE_DIR)) {
-            std::filesystem::create_directory(CACHE_DIR);
+        if (!std::filesystem::exists(directory)) {
+            std::filesystem::create_directory(directory);
         }
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to create cache directory: " + std::string(e.what()));
     }
-    
-    for (size_t i = 0; i < threadCount; ++i) {
-        workers.emplace_back(&TTSCache::fileWriterThread, this);
-    }
+    return directory;
+}
+
+// Constructor ensures cache directory exists, opens the segment store and starts the writer thread
+TTSCache::TTSCache() : diskStore(ensureCacheDir()), stopThreads(false) {
+    writerThread = std::thread(&TTSCache::fileWriterThread, this);
 }
 
 // Destructor ensures all threads stop and finish processing
@@ -30,98 +37,486 @@ TTSCache::~TTSCache() {
         stopThreads = true;
     }
     queueCondition.notify_all();
-    for (std::thread& worker : workers) {
-        if (worker.joinable()) {
-            worker.join();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3_x64_128 (Austin Appleby, public domain). Non-cryptographic; keys are not secrets.
+static void murmurHash3x64_128(const uint8_t* data, size_t len, uint64_t seed, uint64_t out[2]) {
+    const size_t nblocks = len / 16;
+    uint64_t h1 = seed, h2 = seed;
+    const uint64_t c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < nblocks; ++i) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i * 16, 8);
+        std::memcpy(&k2, data + i * 16 + 8, 8);
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = data + nblocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= uint64_t(tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= uint64_t(tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= uint64_t(tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= uint64_t(tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= uint64_t(tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= uint64_t(tail[9]) << 8; [[fallthrough]];
+        case 9:  k2 ^= uint64_t(tail[8]);
+                 k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+                 [[fallthrough]];
+        case 8:  k1 ^= uint64_t(tail[7]) << 56; [[fallthrough]];
+        case 7:  k1 ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+        case 6:  k1 ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+        case 5:  k1 ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+        case 4:  k1 ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+        case 3:  k1 ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+        case 2:  k1 ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+        case 1:  k1 ^= uint64_t(tail[0]);
+                 k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+    out[0] = h1;
+    out[1] = h2;
+}
+
+static void appendField(std::string& buffer, const std::string& field) {
+    uint32_t length = static_cast<uint32_t>(field.size());
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer.append(field);
+}
+
+// Key over the length-prefixed tuple (vendor, voice, format, rate, text), so fields cannot run into
+// each other the way plain concatenation allowed. 32 lowercase hex characters.
+std::string TTSCache::generateKey(const std::string& vendor, const std::string& voiceName, const std::string& format,
+                                  int sampleRate, const std::string& text) {
+    thread_local std::string tuple;
+    tuple.clear();
+    appendField(tuple, vendor);
+    appendField(tuple, voiceName);
+    appendField(tuple, format);
+    uint32_t rate = static_cast<uint32_t>(sampleRate);
+    tuple.append(reinterpret_cast<const char*>(&rate), sizeof(rate));
+    appendField(tuple, text);
+
+    uint64_t hash[2];
+    murmurHash3x64_128(reinterpret_cast<const uint8_t*>(tuple.data()), tuple.size(), 0, hash);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string key(32, '0');
+    for (int word = 0; word < 2; ++word) {
+        for (int i = 0; i < 16; ++i) {
+            key[word * 16 + i] = digits[(hash[word] >> (60 - 4 * i)) & 0xF];
         }
     }
+    return key;
 }
 
-// Generate SHA-256 hash for file naming
-std::string TTSCache::generateHash(const std::string& vendor, const std::string& voiceName, const std::string& text) {
-    std::string input = vendor + voiceName + text;
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(reinterpret_cast<const unsigned char*>(input.c_str()), input.length(), hash);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+// Applies the enabled rules to the text used for the key; the vendor still gets the original text
+std::string TTSCache::normalizeText(const std::string& text, const TextNormalization& rules) {
+    std::string out;
+    out.reserve(text.size());
+    bool pendingSpace = false;
+    for (unsigned char c : text) {
+        if (rules.stripPunctuation && c < 0x80 && std::ispunct(c)) {
+            continue;
+        }
+        if (rules.collapseWhitespace && std::isspace(c)) {
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            out.push_back(' ');
+            pendingSpace = false;
+        }
+        // Only ASCII is folded; multi-byte UTF-8 passes through untouched
+        out.push_back(rules.foldCase && c < 0x80 ? static_cast<char>(std::tolower(c)) : static_cast<char>(c));
+    }
+    return out;
+}
+
+std::string TTSCache::makeKey(const std::string& vendor, const std::string& voiceName, const std::string& format,
+                              int sampleRate, const std::string& text, bool* normalized) {
+    TextNormalization rules;
+    {
+        std::lock_guard<std::mutex> lock(normalizationMutex);
+        rules = textNormalization;
     }
-    return ss.str();
+    std::string canonical = normalizeText(text, rules);
+    if (normalized) *normalized = canonical != text;
+    return generateKey(vendor, voiceName, format, sampleRate, canonical);
 }
 
-// Get file path from hash
-std::string TTSCache::getCacheFilePath(const std::string& hash) {
-    return std::string(CACHE_DIR) + hash + ".raw";
+void TTSCache::setTextNormalization(const TextNormalization& rules) {
+    std::lock_guard<std::mutex> lock(normalizationMutex);
+    textNormalization = rules;
+}
+
+TTSCache::TextNormalization TTSCache::getTextNormalization() {
+    std::lock_guard<std::mutex> lock(normalizationMutex);
+    return textNormalization;
+}
+
+TTSCache::Shard& TTSCache::shardFor(const std::string& key) {
+    return shards[std::hash<std::string>{}(key) % shardCount];
 }
 
 // Check if audio is cached (memory or disk)
 bool TTSCache::isCached(const std::string& key) {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    if (memoryCache.find(key) != memoryCache.end()) {
-        return true;
+    Shard& shard = shardFor(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.memoryCache.find(key);
+        if (it != shard.memoryCache.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            memoryHits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
     }
-    return std::filesystem::exists(getCacheFilePath(key));
+    memoryMisses.fetch_add(1, std::memory_order_relaxed);
+    return diskStore.contains(key);
+}
+
+TTSCache::LabelCounters* TTSCache::labelCounters(const std::string& label) {
+    if (label.empty()) return nullptr;
+    std::lock_guard<std::mutex> lock(labelMutex);
+    auto& counters = labelStats[label];
+    if (!counters) counters = std::make_unique<LabelCounters>();
+    return counters.get();
+}
+
+static uint64_t elapsedNanos(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
-// Retrieve audio from cache (memory or disk)
-std::vector<uint8_t> TTSCache::getCachedAudio(const std::string& key) {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    
-    if (memoryCache.find(key) != memoryCache.end()) {
-        return memoryCache[key];
+// Retrieve audio from cache (memory or disk) in one lookup; empty on a miss.
+// Disk misses are answered by the store's Bloom filter without touching the file system.
+CachedAudio TTSCache::getCachedAudio(const std::string& key, const std::string& label, bool normalizedKey) {
+    return getCachedAudio(key, labelCounters(label), normalizedKey);
+}
+
+CachedAudio TTSCache::getCachedAudio(const std::string& key, LabelCounters* counters, bool normalizedKey) {
+    auto start = std::chrono::steady_clock::now();
+    Shard& shard = shardFor(key);
+    AudioPtr audio;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.memoryCache.find(key);
+        if (it != shard.memoryCache.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            audio = it->second->audio;
+        }
+    }
+    if (normalizedKey) normalizedLookups.fetch_add(1, std::memory_order_relaxed);
+    if (audio) {
+        memoryHits.fetch_add(1, std::memory_order_relaxed);
+        if (normalizedKey) normalizedHits.fetch_add(1, std::memory_order_relaxed);
+        memoryLookupLatency.record(elapsedNanos(start));
+        if (counters) counters->hits.fetch_add(1, std::memory_order_relaxed);
+        return CachedAudio(std::move(audio));
+    }
+    memoryMisses.fetch_add(1, std::memory_order_relaxed);
+
+    if (TTSSharedTier* shared = sharedTier.load(std::memory_order_acquire)) {
+        // Copied out of the arena and not promoted, so the audio stays held once per host
+        audio = shared->read(key);
+        sharedLookupLatency.record(elapsedNanos(start));
+        if (audio) {
+            sharedHits.fetch_add(1, std::memory_order_relaxed);
+            if (normalizedKey) normalizedHits.fetch_add(1, std::memory_order_relaxed);
+            if (counters) counters->hits.fetch_add(1, std::memory_order_relaxed);
+            return CachedAudio(std::move(audio));
+        }
+        sharedMisses.fetch_add(1, std::memory_order_relaxed);
     }
-    
-    std::ifstream file(getCacheFilePath(key), std::ios::binary);
-    if (!file) return {};
-    
-    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    CachedAudio cached = diskStore.read(key);
+    diskLookupLatency.record(elapsedNanos(start));
+    bool hit = !cached.empty();
+    (hit ? diskHits : diskMisses).fetch_add(1, std::memory_order_relaxed);
+    if (hit && normalizedKey) normalizedHits.fetch_add(1, std::memory_order_relaxed);
+    if (counters) (hit ? counters->hits : counters->misses).fetch_add(1, std::memory_order_relaxed);
+    return cached;
 }
 
 // Save audio to cache (memory and queue for async disk writing)
-void TTSCache::saveToCache(const std::string& key, const std::vector<uint8_t>& audioData) {
+void TTSCache::saveToCache(const std::string& key, const std::vector<uint8_t>& audioData, const std::string& label) {
+    saveToCache(key, std::make_shared<const std::vector<uint8_t>>(audioData), label);
+}
+
+void TTSCache::saveToCache(const std::string& key, AudioPtr audio, const std::string& label) {
+    saveToCache(key, std::move(audio), labelCounters(label));
+}
+
+void TTSCache::saveToCache(const std::string& key, AudioPtr audio, LabelCounters* counters) {
+    if (!audio) return;
+    if (counters) {
+        counters->saves.fetch_add(1, std::memory_order_relaxed);
+        counters->savedBytes.fetch_add(audio->size(), std::memory_order_relaxed);
+    }
+    // One shared buffer serves both the memory tier and the disk writer
+    TTSSharedTier* shared = sharedTier.load(std::memory_order_acquire);
+    bool inSharedTier = shared && shared->insert(key, audio->data(), audio->size());
+    Shard& shard = shardFor(key);
     {
-        std::lock_guard<std::mutex> lock(cacheMutex);
-        if (memoryCache.size() >= maxCacheSize) {
-            evictOldest();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.memoryCache.find(key);
+        if (it != shard.memoryCache.end()) {
+            // Re-save replaces the entry in place instead of adding a second one
+            shard.bytes -= it->second->audio->size();
+            shard.lru.erase(it->second);
+            shard.memoryCache.erase(it);
+        }
+        if (!inSharedTier && audio->size() <= memoryBudgetBytes.load(std::memory_order_relaxed) / shardCount) {
+            shard.lru.push_front({key, audio});
+            shard.memoryCache[key] = shard.lru.begin();
+            shard.bytes += audio->size();
+            evictToBudget(shard);
         }
-        memoryCache[key] = audioData;
-        cacheOrder.push_back(key);
     }
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        fileWriteQueue.emplace(key, audioData);
+        auto it = pendingWrites.find(key);
+        if (it != pendingWrites.end()) {
+            // Not written yet: the newer audio replaces it and keeps its place in line
+            pendingWriteBytes = pendingWriteBytes - it->second->size() + audio->size();
+            it->second = std::move(audio);
+            coalescedWrites.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (pendingWriteBytes + audio->size() > maxPendingWriteBytes.load(std::memory_order_relaxed)) {
+            // Never block synthesis on the disk; the audio is still served from memory
+            droppedWrites.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pendingWriteBytes += audio->size();
+        pendingWrites.emplace(key, std::move(audio));
+        writeOrder.push(key);
     }
     queueCondition.notify_one();
 }
 
-// Worker thread function to process file writes
+void TTSCache::setMemoryBudget(size_t bytes) {
+    memoryBudgetBytes = bytes;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evictToBudget(shard);
+    }
+}
+
+size_t TTSCache::getMemoryBudget() const {
+    return memoryBudgetBytes.load();
+}
+
+bool TTSCache::isDiskIndexLoaded() const {
+    return diskStore.isIndexLoaded();
+}
+
+size_t TTSCache::getMemoryResidentBytes() {
+    size_t total = 0;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.bytes;
+    }
+    return total;
+}
+
+double TTSCache::getMemoryHitRatio() const {
+    uint64_t hits = memoryHits.load();
+    uint64_t lookups = hits + memoryMisses.load();
+    return lookups ? static_cast<double>(hits) / lookups : 0.0;
+}
+
+void TTSCache::setDiskCompression(bool enabled, int level) {
+    diskStore.setCompression(enabled ? TTSSegmentStore::Codec::Zlib : TTSSegmentStore::Codec::Raw, level);
+}
+
+TTSSegmentStore::CompressionStats TTSCache::getDiskCompressionStats() const {
+    return diskStore.getCompressionStats();
+}
+
+bool TTSCache::enableSharedTier(const std::string& name, size_t arenaBytes) {
+    std::lock_guard<std::mutex> lock(sharedTierMutex);
+    if (sharedTierOwner) return sharedTierOwner->name() == name;
+    try {
+        sharedTierOwner = std::make_unique<TTSSharedTier>(name, arenaBytes);
+    } catch (const std::exception& e) {
+        std::cerr << "Shared cache tier disabled: " << e.what() << std::endl;
+        return false;
+    }
+    sharedTier.store(sharedTierOwner.get(), std::memory_order_release);
+    return true;
+}
+
+bool TTSCache::isSharedTierEnabled() const {
+    return sharedTier.load() != nullptr;
+}
+
+void TTSCache::setDiskBudget(uint64_t bytes, uint64_t minFreeBytes) {
+    diskStore.setDiskBudget(bytes, minFreeBytes);
+}
+
+uint64_t TTSCache::getDiskBudget() const {
+    return diskStore.getDiskBudget();
+}
+
+void TTSCache::setDurability(Durability policy) {
+    durability = policy;
+}
+
+void TTSCache::setMaxPendingWriteBytes(size_t bytes) {
+    maxPendingWriteBytes = bytes;
+}
+
+size_t TTSCache::getPendingWriteBytes() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return pendingWriteBytes;
+}
+
+uint64_t TTSCache::getCoalescedWrites() const {
+    return coalescedWrites.load();
+}
+
+uint64_t TTSCache::getDroppedWrites() const {
+    return droppedWrites.load();
+}
+
+TTSCacheStats TTSCache::getStats() {
+    TTSCacheStats stats;
+    stats.memoryHits = memoryHits.load();
+    stats.memoryMisses = memoryMisses.load();
+    stats.memoryEvictions = memoryEvictions.load();
+    stats.memoryBudgetBytes = memoryBudgetBytes.load();
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.memoryEntries += shard.memoryCache.size();
+        stats.memoryResidentBytes += shard.bytes;
+    }
+
+    if (TTSSharedTier* shared = sharedTier.load()) {
+        stats.sharedTierEnabled = true;
+        stats.sharedArenaBytes = shared->arenaBytes();
+        stats.sharedInserts = shared->insertCount();
+        stats.sharedTornReads = shared->tornReads();
+    }
+    stats.sharedHits = sharedHits.load();
+    stats.sharedMisses = sharedMisses.load();
+
+    stats.diskHits = diskHits.load();
+    stats.diskMisses = diskMisses.load();
+    stats.diskEntries = diskStore.entryCount();
+    stats.diskTotalBytes = diskStore.totalBytes();
+    stats.diskLiveBytes = diskStore.liveBytes();
+    stats.diskIndexLoaded = diskStore.isIndexLoaded();
+    TTSSegmentStore::CompressionStats compression = diskStore.getCompressionStats();
+    stats.compressedEntries = compression.compressedEntries;
+    stats.compressionRatio = compression.ratio();
+    stats.averageDecodeMicros = compression.averageDecodeMicros();
+    TTSSegmentStore::EvictionStats eviction = diskStore.getEvictionStats();
+    stats.diskBudgetBytes = diskStore.getDiskBudget();
+    stats.diskEvictedEntries = eviction.evictedEntries;
+    stats.diskEvictedBytes = eviction.evictedBytes;
+    stats.diskReclaimedBytes = eviction.reclaimedBytes;
+    stats.diskEvictionPasses = eviction.passes;
+    stats.diskReclaimMillis = eviction.reclaimNanos / 1e6;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stats.writeQueueDepth = writeOrder.size();
+        stats.writeQueueBytes = pendingWriteBytes;
+    }
+    stats.writesCompleted = completedWrites.load();
+    stats.writesCoalesced = coalescedWrites.load();
+    stats.writesDropped = droppedWrites.load();
+    stats.writeErrors = writeErrors.load();
+
+    stats.normalizedLookups = normalizedLookups.load();
+    stats.normalizedHits = normalizedHits.load();
+
+    stats.memoryLookupLatency = memoryLookupLatency.snapshot();
+    stats.diskLookupLatency = diskLookupLatency.snapshot();
+    stats.sharedLookupLatency = sharedLookupLatency.snapshot();
+    {
+        std::lock_guard<std::mutex> lock(labelMutex);
+        for (const auto& [label, counters] : labelStats) {
+            TTSCacheStats::LabelStats& snapshot = stats.labels[label];
+            snapshot.hits = counters->hits.load(std::memory_order_relaxed);
+            snapshot.misses = counters->misses.load(std::memory_order_relaxed);
+            snapshot.saves = counters->saves.load(std::memory_order_relaxed);
+            snapshot.savedBytes = counters->savedBytes.load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+// Writer thread: takes everything queued so far as one batch and appends it to the segment store.
+// Records are indexed only once fully written and carry a CRC, so readers never see a torn entry.
 void TTSCache::fileWriterThread() {
+    pthread_setname_np(pthread_self(), "TTSCacheWriter");
     while (true) {
-        std::pair<std::string, std::vector<uint8_t>> task;
+        std::vector<std::pair<std::string, AudioPtr>> batch;
         {
             std::unique_lock<std::mutex> lock(queueMutex);
-            queueCondition.wait(lock, [this] { return stopThreads || !fileWriteQueue.empty(); });
-            if (stopThreads && fileWriteQueue.empty()) return;
-            task = std::move(fileWriteQueue.front());
-            fileWriteQueue.pop();
-        }
-        try {
-            std::ofstream file(getCacheFilePath(task.first), std::ios::binary);
-            if (!file) {
-                throw std::runtime_error("Failed to open file for writing: " + getCacheFilePath(task.first));
+            queueCondition.wait(lock, [this] { return stopThreads || !writeOrder.empty(); });
+            if (stopThreads && writeOrder.empty()) return;
+            batch.reserve(writeOrder.size());
+            while (!writeOrder.empty()) {
+                auto it = pendingWrites.find(writeOrder.front());
+                writeOrder.pop();
+                pendingWriteBytes -= it->second->size();
+                batch.emplace_back(it->first, std::move(it->second));
+                pendingWrites.erase(it);
             }
-            file.write(reinterpret_cast<const char*>(task.second.data()), task.second.size());
-        } catch (const std::exception& e) {
-            std::cerr << "Error writing to file: " << e.what() << std::endl;
+        }
+
+        Durability policy = durability.load();
+        for (const auto& [key, audio] : batch) {
+            if (!diskStore.append(key, audio->data(), audio->size())) {
+                std::cerr << "Error writing to cache segment for key " << key << std::endl;
+                writeErrors.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            completedWrites.fetch_add(1, std::memory_order_relaxed);
+            if (policy == Durability::EveryWrite) {
+                diskStore.sync();
+            }
+        }
+        if (policy == Durability::Batch) {
+            diskStore.sync();
         }
     }
 }
 
-// Remove oldest cache entry
-void TTSCache::evictOldest() {
-    if (cacheOrder.empty()) return;
-    std::string oldestKey = cacheOrder.front();
-    cacheOrder.pop_front();
-    memoryCache.erase(oldestKey);
+// Drop least recently used entries until the shard fits its share of the budget; caller holds shard.mutex
+void TTSCache::evictToBudget(Shard& shard) {
+    size_t shardBudget = memoryBudgetBytes.load(std::memory_order_relaxed) / shardCount;
+    while (shard.bytes > shardBudget && !shard.lru.empty()) {
+        Entry& oldest = shard.lru.back();
+        shard.bytes -= oldest.audio->size();
+        shard.memoryCache.erase(oldest.key);
+        shard.lru.pop_back();
+        memoryEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
 }
\ No newline at end of file
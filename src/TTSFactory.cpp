@@ -3,15 +3,65 @@
 #include "MicrosoftTTS.h"
 #include "DeepgramTTS.h"
 #include "ElevenlabsTTS.h"
+#include "HedgedTTS.h"
+#include "ModulePool.h"
+
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex registryMutex;
+
+std::map<std::string, TTSFactory::Creator>& registry() {
+    static std::map<std::string, TTSFactory::Creator> providers = {
+        {"Microsoft", [](const std::string& sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName) {
+             return std::make_shared<MicrosoftTTS>(sid, callback, voiceName);
+         }},
+        {"Deepgram", [](const std::string& sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName) {
+             return std::make_shared<DeepgramTTS>(sid, callback, voiceName);
+         }},
+        {"Elevenlabs", [](const std::string& sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName) {
+             return std::make_shared<ElevenlabsTTS>(sid, callback, voiceName);
+         }},
+    };
+    return providers;
+}
+
+} // namespace
 
 std::shared_ptr<I_TTSModule> TTSFactory::CreateTTSModule(const std::string& provider, const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName) {
-    if (provider == "Microsoft") {
-        return std::make_shared<MicrosoftTTS>(stream_sid, callback, voiceName);
-    } else if (provider == "Deepgram") {
-        return std::make_shared<DeepgramTTS>(stream_sid, callback, voiceName);
-    } else if (provider == "Elevenlabs") {
-        return std::make_shared<ElevenlabsTTS>(stream_sid, callback, voiceName);
+    Creator creator;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = registry().find(provider);
+        if (it != registry().end()) creator = it->second;
     }
-    // Add other providers here
-    throw std::runtime_error("Unsupported TTS provider");
+    if (!creator) throw std::runtime_error("Unsupported TTS provider");
+    return creator(stream_sid, callback, voiceName);
+}
+
+std::shared_ptr<I_TTSModule> TTSFactory::CreateHedgedTTSModule(const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::shared_ptr<I_TTSModule> primary, std::shared_ptr<I_TTSModule> secondary, std::chrono::milliseconds firstAudioDeadline, std::chrono::milliseconds segmentDeadline) {
+    auto primaryModule = std::dynamic_pointer_cast<TTSModuleBase>(primary);
+    auto secondaryModule = std::dynamic_pointer_cast<TTSModuleBase>(secondary);
+    if (!primaryModule || !secondaryModule) {
+        throw std::runtime_error("Hedged TTS requires modules created by TTSFactory");
+    }
+    return std::make_shared<HedgedTTS>(stream_sid, callback, primaryModule, secondaryModule, firstAudioDeadline, segmentDeadline);
+}
+
+std::shared_ptr<I_TTSModule> TTSFactory::LeaseTTSModule(const std::string& provider, const std::string& stream_sid, std::function<void(const std::vector<uint8_t>&)> callback, std::string voiceName) {
+    return ModulePool::getInstance().leaseTTS(provider, voiceName, stream_sid, callback);
+}
+
+void TTSFactory::RegisterProvider(const std::string& provider, Creator creator) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry()[provider] = std::move(creator);
+}
+
+std::vector<std::string> TTSFactory::Providers() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<std::string> names;
+    for (const auto& entry : registry()) names.push_back(entry.first);
+    return names;
 }
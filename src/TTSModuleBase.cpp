@@ -1,13 +1,28 @@
 #include "TTSModuleBase.h"
+#include "AudioResampler.h"
+#include "AudioSplicer.h"
 
 
 TTSModuleBase::TTSModuleBase(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb, std::string voiceName)
     : stream_sid(sid), callback(cb), m_voiceName(voiceName), processingThread(&TTSModuleBase::ProcessText, this) {}
 
 TTSModuleBase::~TTSModuleBase() {
-    stopProcessing = true;
+    StopProcessing();
+}
+
+void TTSModuleBase::StopProcessing() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopProcessing = true;
+    }
     queueCV.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(prewarmMutex);
+        stopPrewarm = true;
+    }
+    prewarmCV.notify_all();
     if (processingThread.joinable()) processingThread.join();
+    if (prewarmThread.joinable()) prewarmThread.join();
 }
 
 std::vector<std::string> TTSModuleBase::splitText(const std::string& text) {
@@ -36,7 +51,11 @@ std::vector<std::string> TTSModuleBase::splitText(const std::string& text) {
     return segments;
 }
 
-void TTSModuleBase::PlayAudioBuffer(std::vector<uint8_t> audioBuffer){
+void TTSModuleBase::PlayAudioBuffer(const std::vector<uint8_t>& audioBuffer){
+    PlayAudioBuffer(audioBuffer.data(), audioBuffer.size());
+}
+
+void TTSModuleBase::PlayAudioBuffer(const uint8_t* audioData, size_t size){
     /* 
         Temporary buffer for reading 20ms=160 40ms = 320 80ms = 640
 
@@ -48,38 +67,61 @@ void TTSModuleBase::PlayAudioBuffer(std::vector<uint8_t> audioBuffer){
     */
 
     int ms = 20;
-    int sampleRate = 8000;
+    int sampleRate = m_outputSampleRate;
     int samples = (ms * sampleRate) / 1000;
     int bitDepth = 16;
     int bytesPerChunk = samples * (bitDepth / 8);
 
-    if (audioBuffer.size()==0){
+    // A cancelled speech gets its end marker from ProcessText
+    if (IsSpeechCancelled()) return;
+
+    if (size==0){
         if(!stopProcessing){
-            callback(audioBuffer); // Process each chunk
+            callback(std::vector<uint8_t>()); // Process each chunk
         }
     }
 
-    for (size_t i = 0; i < audioBuffer.size(); i += bytesPerChunk) {
-        std::vector<uint8_t> tempBuffer(audioBuffer.begin() + i, 
-                                        audioBuffer.begin() + std::min(i + bytesPerChunk, audioBuffer.size()));
+    for (size_t i = 0; i < size; i += bytesPerChunk) {
+        if (IsSpeechCancelled()) break;
+        std::vector<uint8_t> tempBuffer(audioData + i, 
+                                        audioData + std::min(i + bytesPerChunk, size));
         
         if(!stopProcessing){
+            // The consumer starves when a chunk arrives more than a frame after the previous one was due
+            int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            int64_t last = m_lastChunkAtNanos.exchange(now);
+            if (last && now - last > 2 * std::chrono::nanoseconds(std::chrono::milliseconds(ms)).count()) {
+                m_metrics.incrementCounter(Metric::TTSPlayoutUnderrun);
+            }
             callback(tempBuffer); // Process each chunk
+            if (!m_audioPlayed.exchange(true)) {
+                // Resolve outside the lock: continuations run inline and may call back into this module
+                SpeakHandle handle;
+                {
+                    std::lock_guard<std::mutex> lock(speechMutex);
+                    handle = m_activeHandle;
+                }
+                handle.firstAudio.resolve(true);
+            }
+        }
+        if (m_pacePlayout) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms)); // Simulate playback delay
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms)); // Simulate playback delay
     }
 }
 
 void TTSModuleBase::ProcessText() {
     pthread_setname_np(pthread_self(), "TTSModuleBaseThread");
     while (!stopProcessing) {
-        std::pair<std::string, std::string> task;
+        SpeakTask task;
         {
             std::unique_lock<std::mutex> lock(queueMutex);
             queueCV.wait(lock, [this] { return stopProcessing || !textQueue.empty(); });
             
             if (stopProcessing) {
                 while (!textQueue.empty()) {
+                    textQueue.front().handle.firstAudio.resolve(false);
+                    textQueue.front().handle.done.resolve(SpeakOutcome::Cancelled);
                     textQueue.pop();
                 }
                 SPDLOG_INFO("[{}] Stopping synthesis thread.",stream_sid);
@@ -91,69 +133,489 @@ void TTSModuleBase::ProcessText() {
             }
             task = std::move(textQueue.front());
             textQueue.pop();
+            m_activeEpoch = task.epoch;
+            m_audioPlayed = false;
+            m_speaking = true;
         }
+        {
+            std::lock_guard<std::mutex> lock(speechMutex);
+            m_activeHandle = task.handle;
+        }
+        m_lastChunkAtNanos = 0;
+        m_metrics.recordLatency(Metric::TTSQueueWait, task.queuedAt);
 
-        std::string command = task.first;
-        std::string text = task.second;
+        bool failed = false;
+        try {
+            if (!IsSpeechCancelled()) RunTask(task);
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("[{}] Speech failed: {}", stream_sid, e.what());
+            failed = true;
+        }
 
-        std::vector<std::string> segments = splitText(text);
+        SpeakOutcome outcome = SpeakOutcome::Completed;
+        if (IsSpeechCancelled()) {
+            outcome = SpeakOutcome::Cancelled;
+            // Playout was cut short; still tell the consumer it ended
+            if (m_audioPlayed && !stopProcessing) callback(std::vector<uint8_t>());
+        } else if (failed || !m_audioPlayed) {
+            outcome = SpeakOutcome::Failed;
+        }
+        task.handle.firstAudio.resolve(false);
+        task.handle.done.resolve(outcome);
+        // Only now may Rebind() swap the callback: the end marker above went to this task's session
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            m_speaking = false;
+        }
+    }
+}
 
-        for (auto it = segments.begin(); it != segments.end(); ++it) {
-            auto segment = *it;  
-            
-            SPDLOG_INFO("[{}] Segment : {}", stream_sid, segment);
-
-            if (it == segments.begin()) {
-                SPDLOG_INFO( "[{}] Start PLAY",stream_sid );
-            } 
-
-            std::string hashKey = TTSCache::generateHash(m_vendorName, m_voiceName, segment);
-
-            // Check cache first
-            if (TTSCache::getInstance().isCached(hashKey)) {
-                SPDLOG_INFO("[{}] Using cached TTS for '{}'", stream_sid, segment);
-                std::vector<uint8_t> cachedAudio = TTSCache::getInstance().getCachedAudio(hashKey);
-                PlayAudioBuffer(cachedAudio);
-                if (std::next(it) == segments.end()) {
-                    SPDLOG_INFO( "[{}] Stop PLAY",stream_sid );
-                    std::vector<uint8_t> tempBuffer;
-                    tempBuffer.clear();
-                    PlayAudioBuffer(tempBuffer);
-                }
-                continue;
-            }
+void TTSModuleBase::RunTask(const SpeakTask& task) {
+    if (task.command == "template") {
+        SpeakPieces(task.pieces);
+        return;
+    }
+
+    std::vector<std::string> segments = splitText(task.text);
+
+    for (auto it = segments.begin(); it != segments.end(); ++it) {
+        if (IsSpeechCancelled()) return;
+        auto segment = *it;  
+        
+        SPDLOG_DEBUG("[{}] Segment : {}", stream_sid, segment);
+
+        if (it == segments.begin()) {
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Start PLAY ({} segments)", stream_sid, segments.size());
+        } 
 
-            // Call text to speech synthesiser 
-            ImplSynthesiseVoice(segment,hashKey);
+        bool normalizedKey = false;
+        std::string hashKey = CacheKey(segment, &normalizedKey);
 
+        // Check cache first
+        auto segmentStart = std::chrono::steady_clock::now();
+        CachedAudio cachedAudio = TTSCache::getInstance().getCachedAudio(hashKey, CacheCounters(), normalizedKey);
+        if (!cachedAudio.empty()) {
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Using cached TTS ({} bytes)", stream_sid, cachedAudio.size());
+            m_metrics.recordLatency(Metric::TTSCachedPlayoutStart, segmentStart);
+            PlayAudioBuffer(cachedAudio.data(), cachedAudio.size());
             if (std::next(it) == segments.end()) {
-                SPDLOG_INFO( "[{}] Stop PLAY",stream_sid );
+                VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Stop PLAY", stream_sid);
                 std::vector<uint8_t> tempBuffer;
                 tempBuffer.clear();
                 PlayAudioBuffer(tempBuffer);
             }
+            continue;
+        }
+
+        // Call text to speech synthesiser 
+        SynthesiseOrJoin(segment, hashKey);
+
+        if (std::next(it) == segments.end()) {
+            VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Stop PLAY", stream_sid);
+            std::vector<uint8_t> tempBuffer;
+            tempBuffer.clear();
+            PlayAudioBuffer(tempBuffer);
         }
     }
 }
 
 void TTSModuleBase::SynthesisedAudioData(std::vector<uint8_t> audioData,std::string hashKey,int latencyMs) {
-    TTSCache::getInstance().saveToCache(hashKey, audioData);
-    PlayAudioBuffer(audioData);
+    if (m_reportsVendorMetrics) {
+        m_metrics.recordLatency(Metric::TTSSynthesisTime, static_cast<double>(latencyMs));
+    }
+    if (m_vendorSampleRate != m_outputSampleRate && !audioData.empty()) {
+        audioData = AudioResampler::convert(audioData, m_vendorSampleRate, m_outputSampleRate);
+    }
+
+    AudioSink sink;
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        sink = m_audioSink;
+    }
+    if (sink) {
+        sink(std::move(audioData), latencyMs);
+        return;
+    }
+
+    auto audio = std::make_shared<const std::vector<uint8_t>>(std::move(audioData));
+    TTSCache::getInstance().saveToCache(hashKey, audio, CacheCounters());
+    std::shared_ptr<SingleFlight::Flight> flight;
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        flight = m_flight;
+    }
+    if (flight) flight->publish(audio);
+    PlayAudioBuffer(*audio);
 }
 
-void TTSModuleBase::Speak(const std::string& text) {
+void TTSModuleBase::SynthesiseOrJoin(const std::string& segment, const std::string& hashKey) {
+    bool leader = false;
+    auto flight = SingleFlight::getInstance().join(hashKey, leader);
+
+    if (!leader) {
+        VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Joining in-flight synthesis", stream_sid);
+        size_t played = 0;
+        bool ok = flight->follow([this, &played](const std::vector<uint8_t>& chunk) {
+            PlayAudioBuffer(chunk);
+            ++played;
+        }, [this] { return stopProcessing || IsSpeechCancelled(); });
+        if (ok || played > 0 || stopProcessing || IsSpeechCancelled()) return;
+        // The leader produced nothing; try the vendor ourselves
+        SPDLOG_WARN("[{}] In-flight synthesis failed, synthesising '{}' directly", stream_sid, segment);
+        std::lock_guard<std::mutex> vendorLock(vendorMutex);
+        BeginVendorRequest();
+        ImplSynthesiseVoice(segment, hashKey);
+        return;
+    }
+
+    // Followers must be released even if the vendor throws
+    try {
+        std::lock_guard<std::mutex> vendorLock(vendorMutex);
+        {
+            std::lock_guard<std::mutex> lock(synthesisHookMutex);
+            m_flight = flight;
+        }
+        BeginVendorRequest();
+        ImplSynthesiseVoice(segment, hashKey);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(synthesisHookMutex);
+            m_flight.reset();
+        }
+        SingleFlight::getInstance().finish(hashKey, flight, false);
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        m_flight.reset();
+    }
+    SingleFlight::getInstance().finish(hashKey, flight, flight->chunkCount() > 0);
+}
+
+CachedAudio TTSModuleBase::FetchOrSynthesise(const std::string& phrase, const std::function<bool()>& stopped) {
+    bool normalizedKey = false;
+    std::string hashKey = CacheKey(phrase, &normalizedKey);
+    CachedAudio cached = TTSCache::getInstance().getCachedAudio(hashKey, CacheCounters(), normalizedKey);
+    if (!cached.empty()) return cached;
+
+    bool leader = false;
+    auto flight = SingleFlight::getInstance().join(hashKey, leader);
+    if (!leader) {
+        std::vector<uint8_t> joined;
+        bool ok = flight->follow([&joined](const std::vector<uint8_t>& chunk) {
+            joined.insert(joined.end(), chunk.begin(), chunk.end());
+        }, stopped);
+        if (ok && !joined.empty()) return CachedAudio(std::make_shared<const std::vector<uint8_t>>(std::move(joined)));
+        if (stopped()) return {};
+        SPDLOG_WARN("[{}] In-flight synthesis failed, synthesising '{}' directly", SessionId(), phrase);
+        return CachedAudio(SynthesisePhrase(phrase, hashKey));
+    }
+
+    // Followers must be released even if the vendor throws
+    SingleFlight::AudioPtr audio;
+    try {
+        audio = SynthesisePhrase(phrase, hashKey);
+    } catch (...) {
+        SingleFlight::getInstance().finish(hashKey, flight, false);
+        throw;
+    }
+    if (audio) flight->publish(audio);
+    SingleFlight::getInstance().finish(hashKey, flight, audio != nullptr);
+    return CachedAudio(std::move(audio));
+}
+
+SingleFlight::AudioPtr TTSModuleBase::SynthesisePhrase(const std::string& phrase, const std::string& hashKey) {
+    auto captured = std::make_shared<std::vector<uint8_t>>();
+    SynthesiseSegment(phrase, hashKey, std::make_shared<std::atomic<bool>>(false), nullptr,
+                      [captured](std::vector<uint8_t> audio, int latencyMs) { *captured = std::move(audio); });
+    if (captured->empty()) return nullptr;
+    auto audio = std::make_shared<const std::vector<uint8_t>>(std::move(*captured));
+    TTSCache::getInstance().saveToCache(hashKey, audio, CacheCounters());
+    return audio;
+}
+
+void TTSModuleBase::SpeakPieces(const std::vector<std::string>& pieces) {
+    std::vector<CachedAudio> clips;
+    clips.reserve(pieces.size());
+    for (const auto& piece : pieces) {
+        if (stopProcessing || IsSpeechCancelled()) return;
+        CachedAudio clip = FetchOrSynthesise(piece, [this] { return stopProcessing || IsSpeechCancelled(); });
+        if (clip.empty()) {
+            SPDLOG_WARN("[{}] No audio for template piece '{}', skipping it", stream_sid, piece);
+            continue;
+        }
+        clips.push_back(std::move(clip));
+    }
+
+    AudioSplicer::Options options;
+    options.sampleRate = m_outputSampleRate;
+    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Start PLAY (template, {} pieces)", stream_sid, clips.size());
+    PlayAudioBuffer(AudioSplicer::splice(clips, options));
+    VOICEKIT_LOG_SESSION(m_logLimiter, spdlog::level::info, "[{}] Stop PLAY", stream_sid);
+    PlayAudioBuffer(std::vector<uint8_t>());
+}
+
+std::vector<std::string> TTSModuleBase::ExpandTemplate(const std::string& templateText,
+                                                       const std::map<std::string, std::string>& values) {
+    std::vector<std::string> pieces;
+    auto addPiece = [&pieces](std::string piece) {
+        if (piece.find_first_not_of(" \t\n\r") != std::string::npos) pieces.push_back(std::move(piece));
+    };
+
+    size_t pos = 0;
+    while (pos < templateText.size()) {
+        size_t open = templateText.find('{', pos);
+        if (open == std::string::npos) break;
+        size_t close = templateText.find('}', open);
+        if (close == std::string::npos) {
+            throw std::invalid_argument("Unterminated slot in template: " + templateText);
+        }
+        std::string slot = templateText.substr(open + 1, close - open - 1);
+        auto value = values.find(slot);
+        if (value == values.end()) {
+            throw std::invalid_argument("No value for template slot '" + slot + "'");
+        }
+        addPiece(templateText.substr(pos, open - pos));
+        addPiece(value->second);
+        pos = close + 1;
+    }
+    if (pos < templateText.size()) addPiece(templateText.substr(pos));
+    return pieces;
+}
+
+SpeakHandle TTSModuleBase::SpeakTemplate(const std::string& templateText,
+                                         const std::map<std::string, std::string>& values) {
+    return Enqueue({"template", templateText, ExpandTemplate(templateText, values)});
+}
+
+SpeakHandle TTSModuleBase::PrewarmPhrases(const std::vector<std::string>& phrases) {
+    PrewarmJob job{phrases, {}};
+    SpeakHandle handle = job.handle;
+    std::shared_ptr<TTSModuleBase> module;
+    {
+        std::lock_guard<std::mutex> lock(prewarmMutex);
+        module = m_prewarmModule;
+        if (!module && !stopPrewarm) {
+            if (!prewarmThread.joinable()) prewarmThread = std::thread(&TTSModuleBase::PrewarmLoop, this);
+            prewarmQueue.push_back(std::move(job));
+        }
+    }
+    if (module) return module->PrewarmPhrases(phrases);
+    if (stopPrewarm) {
+        handle.firstAudio.resolve(false);
+        handle.done.resolve(SpeakOutcome::Cancelled);
+        return handle;
+    }
+    prewarmCV.notify_one();
+    return handle;
+}
+
+void TTSModuleBase::SetPrewarmModule(std::shared_ptr<TTSModuleBase> module) {
+    if (module) {
+        if (module.get() == this || std::string(module->VendorName()) != VendorName() || module->VoiceName() != m_voiceName) {
+            throw std::invalid_argument("Prewarm module must be another " + StatsLabel() + " module");
+        }
+        module->SetOutputSampleRate(m_outputSampleRate);
+    }
+    std::lock_guard<std::mutex> lock(prewarmMutex);
+    m_prewarmModule = std::move(module);
+}
+
+void TTSModuleBase::PrewarmLoop() {
+    pthread_setname_np(pthread_self(), "TTSPrewarmThread");
+    auto stopped = [this] { return stopPrewarm.load(); };
+    while (true) {
+        PrewarmJob job;
+        {
+            std::unique_lock<std::mutex> lock(prewarmMutex);
+            prewarmCV.wait(lock, [this] { return stopPrewarm || !prewarmQueue.empty(); });
+            if (stopPrewarm) break;
+            job = std::move(prewarmQueue.front());
+            prewarmQueue.pop_front();
+        }
+
+        size_t cached = 0;
+        for (const auto& phrase : job.phrases) {
+            if (stopped()) break;
+            if (!FetchOrSynthesise(phrase, stopped).empty()) ++cached;
+        }
+        SpeakOutcome outcome = SpeakOutcome::Completed;
+        if (stopped()) {
+            outcome = SpeakOutcome::Cancelled;
+        } else if (cached < job.phrases.size()) {
+            SPDLOG_WARN("[{}] Prewarmed {} of {} phrases", SessionId(), cached, job.phrases.size());
+            outcome = SpeakOutcome::Failed;
+        }
+        job.handle.firstAudio.resolve(false);
+        job.handle.done.resolve(outcome);
+    }
+
+    std::lock_guard<std::mutex> lock(prewarmMutex);
+    for (auto& job : prewarmQueue) {
+        job.handle.firstAudio.resolve(false);
+        job.handle.done.resolve(SpeakOutcome::Cancelled);
+    }
+    prewarmQueue.clear();
+}
+
+TTSCache::LabelCounters* TTSModuleBase::CacheCounters() {
+    // VendorName() is virtual, so the label cannot be resolved in the constructor. Two threads
+    // resolving it at once get the same counters.
+    TTSCache::LabelCounters* counters = m_cacheCounters.load(std::memory_order_acquire);
+    if (!counters) {
+        counters = TTSCache::getInstance().labelCounters(StatsLabel());
+        m_cacheCounters.store(counters, std::memory_order_release);
+    }
+    return counters;
+}
+
+std::string TTSModuleBase::CacheKey(const std::string& segment, bool* normalized) const {
+    // Cached audio is what we play out: 16-bit mono PCM at the output rate
+    return TTSCache::getInstance().makeKey(VendorName(), m_voiceName, "pcm_s16le", m_outputSampleRate, segment, normalized);
+}
+
+void TTSModuleBase::BeginVendorRequest() {
+    m_vendorRequestAt = std::chrono::steady_clock::now();
+    m_awaitingFirstChunk.store(m_reportsVendorMetrics, std::memory_order_release);
+}
+
+void TTSModuleBase::AudioChunkReceived() {
+    if (m_awaitingFirstChunk.exchange(false, std::memory_order_acquire)) {
+        m_metrics.recordLatency(Metric::TTSTimeToFirstAudio, m_vendorRequestAt);
+    }
+    std::function<void()> hook;
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        hook = std::move(m_firstAudioHook);
+        m_firstAudioHook = nullptr;
+    }
+    if (hook) hook();
+}
+
+bool TTSModuleBase::IsSynthesisCancelled() {
+    // StopSpeak() only cancels what the speech thread is synthesising, not a prewarm or hedge leg
+    if (m_synthesisForSpeech && IsSpeechCancelled()) return true;
+    std::lock_guard<std::mutex> lock(synthesisHookMutex);
+    return m_cancelToken && m_cancelToken->load();
+}
+
+bool TTSModuleBase::IsSpeechCancelled() const {
+    return m_activeEpoch.load() != m_speechEpoch.load();
+}
+
+void TTSModuleBase::SynthesiseSegment(const std::string& text, const std::string& hashKey,
+                                      std::shared_ptr<std::atomic<bool>> cancelled,
+                                      std::function<void()> onFirstAudio, AudioSink sink) {
+    std::lock_guard<std::mutex> vendorLock(vendorMutex);
+    m_synthesisForSpeech = std::this_thread::get_id() == processingThread.get_id();
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        m_cancelToken = std::move(cancelled);
+        m_firstAudioHook = std::move(onFirstAudio);
+        m_audioSink = std::move(sink);
+    }
+
+    try {
+        BeginVendorRequest();
+        ImplSynthesiseVoice(text, hashKey);
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("[{}] Synthesis failed: {}", stream_sid, e.what());
+    }
+
+    m_synthesisForSpeech = true;
+    std::lock_guard<std::mutex> lock(synthesisHookMutex);
+    m_cancelToken.reset();
+    m_firstAudioHook = nullptr;
+    m_audioSink = nullptr;
+}
+
+void TTSModuleBase::CancelSynthesis() {
+    {
+        std::lock_guard<std::mutex> lock(synthesisHookMutex);
+        if (m_cancelToken) m_cancelToken->store(true);
+    }
+    ImplCancelSynthesis();
+}
+
+SpeakHandle TTSModuleBase::Speak(const std::string& text) {
+    return Enqueue({"start", text, {}});
+}
+
+SpeakHandle TTSModuleBase::Enqueue(SpeakTask task) {
+    SpeakHandle handle = task.handle;
+    task.queuedAt = std::chrono::steady_clock::now();
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        textQueue.push({"start",text});
+        task.epoch = m_speechEpoch.load();
+        textQueue.push(std::move(task));
     }
     queueCV.notify_one();
+    return handle;
 }
 
-
 void TTSModuleBase::StopSpeak() {
+    std::vector<SpeakHandle> dropped;
+    bool speaking;
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        textQueue.push({"stop",""});
+        // Everything queued so far, and the speech playing now, belongs to an older epoch
+        ++m_speechEpoch;
+        while (!textQueue.empty()) {
+            dropped.push_back(textQueue.front().handle);
+            textQueue.pop();
+        }
+        speaking = m_speaking.load();
     }
-    queueCV.notify_one();
+    for (auto& handle : dropped) {
+        handle.firstAudio.resolve(false);
+        handle.done.resolve(SpeakOutcome::Cancelled);
+    }
+    // Wake a vendor waiting on the service so it sees IsSynthesisCancelled()
+    if (speaking && m_synthesisForSpeech) ImplCancelSynthesis();
+}
+
+void TTSModuleBase::ResetForReuse() {
+    StopSpeak();
+    // Prewarming queued for the old session is dropped; a phrase already at the vendor finishes
+    std::deque<PrewarmJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(prewarmMutex);
+        dropped.swap(prewarmQueue);
+    }
+    for (auto& job : dropped) {
+        job.handle.firstAudio.resolve(false);
+        job.handle.done.resolve(SpeakOutcome::Cancelled);
+    }
+}
+
+bool TTSModuleBase::IsIdle() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return textQueue.empty() && !m_speaking;
+}
+
+bool TTSModuleBase::Rebind(const std::string& sid, std::function<void(const std::vector<uint8_t>&)> cb) {
+    // Holding queueMutex keeps the processing thread from taking a task until the new session is in place
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!textQueue.empty() || m_speaking) return false;
+    {
+        std::lock_guard<std::mutex> sessionLock(sessionMutex);
+        stream_sid = sid;
+    }
+    m_metrics.invalidate();
+    callback = std::move(cb);
+    return true;
+}
+
+std::string TTSModuleBase::SessionId() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return stream_sid;
+}
+
+void TTSModuleBase::SetOutputSampleRate(int sampleRate) {
+    if (!AudioResampler::isSupported(8000, sampleRate)) {
+        throw std::invalid_argument("Unsupported TTS output sample rate " + std::to_string(sampleRate));
+    }
+    m_outputSampleRate = sampleRate;
+    std::lock_guard<std::mutex> lock(prewarmMutex);
+    if (m_prewarmModule) m_prewarmModule->SetOutputSampleRate(sampleRate);
 }
\ No newline at end of file
@@ -0,0 +1,781 @@
+#include "TTSSegmentStore.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+
+constexpr uint32_t kRecordMagic = 0x52535454; // "TTSR" little-endian
+constexpr auto kMaintenanceInterval = std::chrono::seconds(60);
+constexpr size_t kMaxPooledBuffers = 32;
+constexpr double kMinCompressionSaving = 0.10;
+constexpr size_t kBloomBits = size_t(1) << 24;  // 2 MB; ~1% false positives at 1.7M keys
+constexpr int kBloomProbes = 5;
+constexpr uint32_t kSecondChanceWindowSeconds = 6 * 3600;  // eviction keeps entries hit this recently
+constexpr double kMaxKeepFraction = 0.5;                    // ...up to this share of the segment
+constexpr uint64_t kMinSegmentBytes = 1ull << 20;
+
+struct RecordHeader {
+    uint32_t magic;
+    uint16_t keyLength;
+    uint8_t codec;        // TTSSegmentStore::Codec
+    uint8_t reserved;
+    uint32_t dataLength;  // payload bytes
+    uint32_t checksum;    // CRC-32 of key and payload
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader must stay packed");
+
+std::string segmentFileName(uint32_t id) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%06u.dat", id);
+    return name;
+}
+
+bool parseSegmentFileName(const std::string& name, uint32_t& id) {
+    unsigned value = 0;
+    char tail[8] = {};
+    if (std::sscanf(name.c_str(), "segment-%6u.%3s", &value, tail) != 2 || std::strcmp(tail, "dat") != 0) {
+        return false;
+    }
+    id = value;
+    return name == segmentFileName(id);
+}
+
+uint32_t recordChecksum(const char* key, size_t keyLength, const uint8_t* data, size_t size) {
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(key), static_cast<uInt>(keyLength));
+    return static_cast<uint32_t>(crc32(crc, data, static_cast<uInt>(size)));
+}
+
+uint64_t recordSize(size_t keyLength, size_t dataLength) {
+    return sizeof(RecordHeader) + keyLength + dataLength;
+}
+
+bool writeAll(int fd, const void* buffer, size_t length, uint64_t offset) {
+    const char* p = static_cast<const char*>(buffer);
+    while (length > 0) {
+        ssize_t written = ::pwrite(fd, p, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+struct TTSSegmentStore::Mapping {
+    void* address = nullptr;
+    size_t length = 0;
+
+    ~Mapping() {
+        if (address) ::munmap(address, length);
+    }
+    const uint8_t* bytes() const { return static_cast<const uint8_t*>(address); }
+};
+
+// Insert-only Bloom filter over relaxed atomics so negative lookups take no lock.
+// Keys removed from the index stay set and just fall through to the index.
+class TTSSegmentStore::BloomFilter {
+public:
+    BloomFilter() : words(kBloomBits / 64) {}
+
+    void add(const std::string& key) {
+        uint64_t h1, h2;
+        hashes(key, h1, h2);
+        for (int i = 0; i < kBloomProbes; ++i) {
+            uint64_t bit = (h1 + i * h2) % kBloomBits;
+            words[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+        }
+    }
+
+    bool mayContain(const std::string& key) const {
+        uint64_t h1, h2;
+        hashes(key, h1, h2);
+        for (int i = 0; i < kBloomProbes; ++i) {
+            uint64_t bit = (h1 + i * h2) % kBloomBits;
+            if (!(words[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64)))) return false;
+        }
+        return true;
+    }
+
+private:
+    // Double hashing (Kirsch-Mitzenmacher) from one 64-bit hash
+    static void hashes(const std::string& key, uint64_t& h1, uint64_t& h2) {
+        uint64_t h = std::hash<std::string>{}(key);
+        h1 = h;
+        h2 = ((h >> 32) | (h << 32)) * 0x9E3779B97F4A7C15ull | 1;
+    }
+
+    std::vector<std::atomic<uint64_t>> words;
+};
+
+// Recycles decode buffers: a buffer returns to the pool when the last view of it is dropped
+class TTSSegmentStore::BufferPool : public std::enable_shared_from_this<BufferPool> {
+public:
+    std::shared_ptr<std::vector<uint8_t>> acquire(size_t size) {
+        std::unique_ptr<std::vector<uint8_t>> buffer;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeBuffers.empty()) {
+                buffer = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        if (!buffer) buffer = std::make_unique<std::vector<uint8_t>>();
+        buffer->resize(size);
+        std::weak_ptr<BufferPool> pool = shared_from_this();
+        return std::shared_ptr<std::vector<uint8_t>>(buffer.release(), [pool](std::vector<uint8_t>* released) {
+            if (auto owner = pool.lock()) {
+                owner->release(released);
+            } else {
+                delete released;
+            }
+        });
+    }
+
+private:
+    void release(std::vector<uint8_t>* buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeBuffers.size() < kMaxPooledBuffers) {
+            freeBuffers.emplace_back(buffer);
+        } else {
+            delete buffer;
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> freeBuffers;
+};
+
+struct TTSSegmentStore::Segment {
+    uint32_t id = 0;
+    std::string path;
+    int fd = -1;
+    std::atomic<uint64_t> size{0};  // append offset; only grows
+    uint64_t liveBytes = 0;         // bytes of records the index still points at
+    std::mutex mapMutex;
+    std::shared_ptr<const Mapping> mapping;
+
+    ~Segment() {
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+TTSSegmentStore::TTSSegmentStore(const std::string& directory, uint64_t maxSegmentBytes)
+    : m_directory(directory), m_maxSegmentBytes(maxSegmentBytes),
+      bloom(std::make_unique<BloomFilter>()), bufferPool(std::make_shared<BufferPool>()) {
+    std::filesystem::create_directories(m_directory);
+
+    std::vector<uint32_t> ids;
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory)) {
+        uint32_t id;
+        if (entry.is_regular_file() && parseSegmentFileName(entry.path().filename().string(), id)) {
+            if (entry.file_size() == 0) {
+                std::filesystem::remove(entry.path());
+                continue;
+            }
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    // Existing segments are only opened here; their records are indexed by the maintenance
+    // thread so startup does not wait on the scan. New records go to a fresh segment and win
+    // over anything the scan finds later.
+    for (uint32_t id : ids) {
+        auto segment = openSegment(id, false);
+        segments[segment->id] = segment;
+        diskBytes += segment->size;
+    }
+    activeSegment = openSegment(ids.empty() ? 1 : ids.back() + 1, true);
+    segments[activeSegment->id] = activeSegment;
+
+    maintenanceWorker = std::thread(&TTSSegmentStore::maintenanceThread, this);
+}
+
+TTSSegmentStore::~TTSSegmentStore() {
+    {
+        std::lock_guard<std::mutex> lock(maintenanceMutex);
+        stopMaintenance = true;
+    }
+    maintenanceCV.notify_all();
+    if (maintenanceWorker.joinable()) {
+        maintenanceWorker.join();
+    }
+}
+
+std::shared_ptr<TTSSegmentStore::Segment> TTSSegmentStore::openSegment(uint32_t id, bool create) {
+    auto segment = std::make_shared<Segment>();
+    segment->id = id;
+    segment->path = (std::filesystem::path(m_directory) / segmentFileName(id)).string();
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (segment->fd < 0) {
+        throw std::runtime_error("Failed to open cache segment " + segment->path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(segment->fd, &st) == 0) {
+        segment->size = static_cast<uint64_t>(st.st_size);
+    }
+    return segment;
+}
+
+// Index the sealed segments in id order, so later records win for keys written more than once
+void TTSSegmentStore::loadIndex() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<Segment>> sealed;
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        for (const auto& [id, segment] : segments) {
+            if (segment != activeSegment) sealed.push_back(segment);
+        }
+    }
+    for (size_t i = 0; i < sealed.size(); ++i) {
+        // Only the segment that was active when the last process stopped can have a torn tail
+        loadSegment(sealed[i], i + 1 == sealed.size());
+        std::lock_guard<std::mutex> lock(maintenanceMutex);
+        if (stopMaintenance) return;
+    }
+    indexLoaded = true;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cerr << "TTS cache index loaded: " << entryCount() << " entries from " << sealed.size()
+              << " segments in " << elapsed.count() << " ms" << std::endl;
+}
+
+// Rebuild index entries from record headers. Headers are scanned without the index lock and
+// applied in one batch, so lookups only wait for the map inserts.
+void TTSSegmentStore::loadSegment(const std::shared_ptr<Segment>& segment, bool verifyChecksums) {
+    uint64_t fileSize = segment->size;
+    if (fileSize == 0) return;
+
+    auto mapping = mappingFor(*segment, fileSize);
+    if (!mapping) return;
+    const uint8_t* base = mapping->bytes();
+
+    std::vector<std::pair<std::string, Location>> records;
+    uint64_t pos = 0;
+    while (pos + sizeof(RecordHeader) <= fileSize) {
+        RecordHeader header;
+        std::memcpy(&header, base + pos, sizeof(header));
+        uint64_t size = recordSize(header.keyLength, header.dataLength);
+        if (header.magic != kRecordMagic || pos + size > fileSize) break;
+
+        const char* key = reinterpret_cast<const char*>(base + pos + sizeof(header));
+        const uint8_t* data = base + pos + sizeof(header) + header.keyLength;
+        if (verifyChecksums && recordChecksum(key, header.keyLength, data, header.dataLength) != header.checksum) break;
+
+        records.emplace_back(std::string(key, header.keyLength),
+                             Location{segment->id, pos + sizeof(header) + header.keyLength, header.dataLength,
+                                      static_cast<Codec>(header.codec)});
+        pos += size;
+    }
+
+    if (pos < fileSize) {
+        std::cerr << "Cache segment " << segment->path << ": ignoring " << (fileSize - pos)
+                  << " bytes of incomplete records" << std::endl;
+        if (verifyChecksums && ::ftruncate(segment->fd, static_cast<off_t>(pos)) != 0) {
+            std::cerr << "Failed to truncate " << segment->path << ": " << std::strerror(errno) << std::endl;
+        }
+        diskBytes -= fileSize - pos;
+        segment->size = pos;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    for (auto& [key, location] : records) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            // A record saved since startup (higher segment id) beats the one on disk
+            if (it->second.location.segment > location.segment) continue;
+            auto previous = segments.find(it->second.location.segment);
+            if (previous != segments.end()) {
+                previous->second->liveBytes -= recordSize(key.size(), it->second.location.length);
+            }
+        }
+        bloom->add(key);
+        segment->liveBytes += recordSize(key.size(), location.length);
+        index[key].location = location;
+    }
+}
+
+// Mapping covering at least `minLength` bytes; the active segment is remapped as it grows
+std::shared_ptr<const TTSSegmentStore::Mapping> TTSSegmentStore::mappingFor(Segment& segment, uint64_t minLength) {
+    std::lock_guard<std::mutex> lock(segment.mapMutex);
+    if (segment.mapping && segment.mapping->length >= minLength) {
+        return segment.mapping;
+    }
+    uint64_t length = std::max<uint64_t>(segment.size.load(), minLength);
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, segment.fd, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Failed to map " << segment.path << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    auto mapping = std::make_shared<Mapping>();
+    mapping->address = address;
+    mapping->length = length;
+    // Readers still holding the previous mapping keep it alive until they drop their views
+    segment.mapping = mapping;
+    return segment.mapping;
+}
+
+bool TTSSegmentStore::contains(const std::string& key) {
+    if (!bloom->mayContain(key)) return false;
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return index.find(key) != index.end();
+}
+
+CachedAudio TTSSegmentStore::read(const std::string& key) {
+    Location location;
+    std::shared_ptr<Segment> segment;
+    if (!bloom->mayContain(key)) return {};
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        auto it = index.find(key);
+        if (it == index.end()) return {};
+        location = it->second.location;
+        segment = segments.at(location.segment);
+        it->second.lastAccess.store(secondsSinceOpen(), std::memory_order_relaxed);
+        it->second.hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto mapping = mappingFor(*segment, location.offset + location.length);
+    if (!mapping) return {};
+    if (location.codec == Codec::Raw) {
+        return CachedAudio(mapping, mapping->bytes() + location.offset, location.length);
+    }
+    return decode(mapping, location);
+}
+
+CachedAudio TTSSegmentStore::decode(const std::shared_ptr<const Mapping>& mapping, const Location& location) {
+    const uint8_t* payload = mapping->bytes() + location.offset;
+    uint32_t rawLength;
+    if (location.codec != Codec::Zlib || location.length < sizeof(rawLength)) {
+        std::cerr << "Unsupported cache record codec " << static_cast<int>(location.codec) << std::endl;
+        return {};
+    }
+    std::memcpy(&rawLength, payload, sizeof(rawLength));
+
+    auto start = std::chrono::steady_clock::now();
+    auto buffer = bufferPool->acquire(rawLength);
+    uLongf decodedLength = rawLength;
+    int rc = uncompress(buffer->data(), &decodedLength, payload + sizeof(rawLength), location.length - sizeof(rawLength));
+    if (rc != Z_OK || decodedLength != rawLength) {
+        std::cerr << "Failed to decompress cache record (zlib " << rc << ")" << std::endl;
+        return {};
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    decodedHits.fetch_add(1, std::memory_order_relaxed);
+    decodeNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+
+    std::shared_ptr<const std::vector<uint8_t>> audio = std::move(buffer);
+    return CachedAudio(std::move(audio));
+}
+
+bool TTSSegmentStore::append(const std::string& key, const uint8_t* data, size_t size) {
+    if (m_codec.load(std::memory_order_relaxed) == Codec::Zlib && size > 0 && size <= UINT32_MAX) {
+        // Compress outside appendMutex; keep the record raw unless it is worth the decode cost
+        uint32_t rawLength = static_cast<uint32_t>(size);
+        std::vector<uint8_t> payload(sizeof(rawLength) + compressBound(size));
+        std::memcpy(payload.data(), &rawLength, sizeof(rawLength));
+        uLongf compressedLength = payload.size() - sizeof(rawLength);
+        if (compress2(payload.data() + sizeof(rawLength), &compressedLength, data, size,
+                      m_compressionLevel.load(std::memory_order_relaxed)) == Z_OK) {
+            size_t stored = sizeof(rawLength) + compressedLength;
+            if (stored <= size * (1.0 - kMinCompressionSaving)) {
+                if (!appendRecord(key, Codec::Zlib, payload.data(), stored, nullptr)) {
+                    requestEviction();
+                    return false;
+                }
+                compressedRawBytes.fetch_add(size, std::memory_order_relaxed);
+                compressedStoredBytes.fetch_add(stored, std::memory_order_relaxed);
+                compressedEntries.fetch_add(1, std::memory_order_relaxed);
+                if (overBudget()) requestEviction();
+                return true;
+            }
+        }
+    }
+    // A failed write is usually a full volume; eviction frees space for the next one
+    bool ok = appendRecord(key, Codec::Raw, data, size, nullptr);
+    if (!ok || overBudget()) requestEviction();
+    return ok;
+}
+
+void TTSSegmentStore::setCompression(Codec codec, int level) {
+    if (codec != Codec::Raw && codec != Codec::Zlib) {
+        throw std::invalid_argument("Unsupported cache codec");
+    }
+    if (level < Z_BEST_SPEED || level > Z_BEST_COMPRESSION) {
+        throw std::invalid_argument("zlib level must be between 1 and 9");
+    }
+    m_compressionLevel = level;
+    m_codec = codec;
+}
+
+TTSSegmentStore::CompressionStats TTSSegmentStore::getCompressionStats() const {
+    CompressionStats stats;
+    stats.rawBytes = compressedRawBytes.load();
+    stats.storedBytes = compressedStoredBytes.load();
+    stats.compressedEntries = compressedEntries.load();
+    stats.decodedHits = decodedHits.load();
+    stats.decodeNanos = decodeNanos.load();
+    return stats;
+}
+
+// Append an encoded record and point the index at it. With `expected` set (compaction), the index is only
+// updated if the key still lives there, so a concurrent save is never overwritten by stale audio.
+bool TTSSegmentStore::appendRecord(const std::string& key, Codec codec, const uint8_t* data, size_t size, const Location* expected) {
+    if (key.size() > UINT16_MAX || size > UINT32_MAX) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(appendMutex);
+
+    uint64_t bytes = recordSize(key.size(), size);
+    if (activeSegment->size + bytes > m_maxSegmentBytes.load() && activeSegment->size > 0) {
+        auto next = openSegment(activeSegment->id + 1, true);
+        {
+            std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+            segments[next->id] = next;
+            unsyncedSegments.push_back(activeSegment);
+            activeSegment = next;
+        }
+    }
+
+    Segment& segment = *activeSegment;
+    uint64_t offset = segment.size;
+    RecordHeader header{kRecordMagic, static_cast<uint16_t>(key.size()), static_cast<uint8_t>(codec), 0,
+                        static_cast<uint32_t>(size), recordChecksum(key.data(), key.size(), data, size)};
+    std::vector<char> prefix(sizeof(header) + key.size());
+    std::memcpy(prefix.data(), &header, sizeof(header));
+    std::memcpy(prefix.data() + sizeof(header), key.data(), key.size());
+
+    if (!writeAll(segment.fd, prefix.data(), prefix.size(), offset) ||
+        !writeAll(segment.fd, data, size, offset + prefix.size())) {
+        std::cerr << "Failed to append to " << segment.path << ": " << std::strerror(errno) << std::endl;
+        // Leave the partial record behind the append offset; the next write overwrites it
+        return false;
+    }
+    segment.size = offset + bytes;
+    diskBytes += bytes;
+
+    // The record is complete before readers can see it through the index
+    std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+    auto it = index.find(key);
+    if (expected) {
+        if (it == index.end() || it->second.location.segment != expected->segment ||
+            it->second.location.offset != expected->offset) {
+            return true; // superseded while copying; the new record is dead on arrival
+        }
+    }
+    if (it != index.end()) {
+        auto previous = segments.find(it->second.location.segment);
+        if (previous != segments.end()) {
+            previous->second->liveBytes -= recordSize(key.size(), it->second.location.length);
+        }
+    }
+    bloom->add(key);
+    IndexEntry& entry = index[key];
+    entry.location = {segment.id, offset + prefix.size(), static_cast<uint32_t>(size), codec};
+    if (!expected) {
+        // A fresh save counts as an access so it is not the first thing evicted
+        entry.lastAccess.store(secondsSinceOpen(), std::memory_order_relaxed);
+    }
+    segment.liveBytes += bytes;
+    return true;
+}
+
+bool TTSSegmentStore::sync() {
+    std::vector<std::shared_ptr<Segment>> pending;
+    {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        pending.swap(unsyncedSegments);
+        pending.push_back(activeSegment);
+    }
+    bool ok = true;
+    for (const auto& segment : pending) {
+        if (::fdatasync(segment->fd) != 0) {
+            std::cerr << "Failed to sync " << segment->path << ": " << std::strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+uint64_t TTSSegmentStore::compact(double minLiveRatio) {
+    std::vector<std::shared_ptr<Segment>> victims;
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        for (const auto& [id, segment] : segments) {
+            if (segment == activeSegment) continue;
+            // Small segments left behind by restarts are merged too
+            if (segment->liveBytes < segment->size * minLiveRatio || segment->size < m_maxSegmentBytes.load() / 16) {
+                victims.push_back(segment);
+            }
+        }
+    }
+
+    uint64_t reclaimed = 0;
+    for (const auto& victim : victims) {
+        uint64_t size = victim->size, copiedBytes = 0;
+        if (rewriteSegment(victim, false, copiedBytes)) {
+            reclaimed += size - copiedBytes;
+        }
+    }
+    return reclaimed;
+}
+
+// Copy the victim's live records forward to the active segment, then delete it. With `evict`, only
+// recently hit records are copied (most recent first, up to kMaxKeepFraction of the segment) and the
+// other live records are dropped from the index.
+bool TTSSegmentStore::rewriteSegment(const std::shared_ptr<Segment>& victim, bool evict, uint64_t& copiedBytes) {
+    uint64_t size = victim->size;
+    auto mapping = size ? mappingFor(*victim, size) : nullptr;
+    if (size && !mapping) return false;
+
+    auto forEachLiveRecord = [&](auto&& visit) {
+        uint64_t pos = 0;
+        while (pos + sizeof(RecordHeader) <= size) {
+            RecordHeader header;
+            std::memcpy(&header, mapping->bytes() + pos, sizeof(header));
+            std::string key(reinterpret_cast<const char*>(mapping->bytes() + pos + sizeof(header)), header.keyLength);
+            Location location{victim->id, pos + sizeof(header) + header.keyLength, header.dataLength,
+                              static_cast<Codec>(header.codec)};
+            pos += recordSize(header.keyLength, header.dataLength);
+
+            bool live;
+            uint32_t lastAccess = 0, hits = 0;
+            {
+                std::shared_lock<std::shared_mutex> lock(indexMutex);
+                auto it = index.find(key);
+                live = it != index.end() && it->second.location.segment == location.segment &&
+                       it->second.location.offset == location.offset;
+                if (live) {
+                    lastAccess = it->second.lastAccess.load(std::memory_order_relaxed);
+                    hits = it->second.hits.load(std::memory_order_relaxed);
+                }
+            }
+            if (live && !visit(key, location, lastAccess, hits)) return false;
+        }
+        return true;
+    };
+
+    std::unordered_set<uint64_t> keep;  // offsets of records that get a second chance
+    if (evict) {
+        struct Candidate {
+            uint64_t offset;
+            uint64_t bytes;
+            uint32_t lastAccess;
+            uint32_t hits;
+        };
+        std::vector<Candidate> candidates;
+        uint32_t now = secondsSinceOpen();
+        forEachLiveRecord([&](const std::string& key, const Location& location, uint32_t lastAccess, uint32_t hits) {
+            if (hits > 0 && now - lastAccess < kSecondChanceWindowSeconds) {
+                candidates.push_back({location.offset, recordSize(key.size(), location.length), lastAccess, hits});
+            }
+            return true;
+        });
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.lastAccess != b.lastAccess ? a.lastAccess > b.lastAccess : a.hits > b.hits;
+        });
+        uint64_t kept = 0;
+        for (const auto& candidate : candidates) {
+            if (kept + candidate.bytes > size * kMaxKeepFraction) break;
+            kept += candidate.bytes;
+            keep.insert(candidate.offset);
+        }
+    }
+
+    bool copied = forEachLiveRecord([&](const std::string& key, const Location& location, uint32_t, uint32_t) {
+        uint64_t bytes = recordSize(key.size(), location.length);
+        if (!evict || keep.count(location.offset)) {
+            // Payloads move as stored; compaction never re-encodes
+            if (!appendRecord(key, location.codec, mapping->bytes() + location.offset, location.length, &location)) {
+                return false;
+            }
+            copiedBytes += bytes;
+            return true;
+        }
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        auto it = index.find(key);
+        if (it != index.end() && it->second.location.segment == location.segment &&
+            it->second.location.offset == location.offset) {
+            victim->liveBytes -= bytes;
+            index.erase(it);
+            evictedEntries.fetch_add(1, std::memory_order_relaxed);
+            evictedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        return true;
+    });
+    // The copies must be durable before the only other copy is deleted
+    if (!copied || (copiedBytes && !sync())) return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        segments.erase(victim->id);
+    }
+    // Views handed out earlier keep their mapping; the file disappears once they are dropped
+    std::error_code ec;
+    std::filesystem::remove(victim->path, ec);
+    diskBytes -= size;
+    return true;
+}
+
+uint32_t TTSSegmentStore::secondsSinceOpen() const {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_openedAt).count());
+}
+
+void TTSSegmentStore::setDiskBudget(uint64_t budgetBytes, uint64_t minFreeBytes) {
+    m_diskBudget = budgetBytes;
+    m_minFreeBytes = budgetBytes ? minFreeBytes : 0;
+    // Eviction works a sealed segment at a time, so keep segments small relative to the budget
+    if (budgetBytes) {
+        m_maxSegmentBytes = std::clamp<uint64_t>(budgetBytes / 8, kMinSegmentBytes, m_maxSegmentBytes.load());
+    }
+    if (overBudget()) requestEviction();
+}
+
+uint64_t TTSSegmentStore::getDiskBudget() const {
+    return m_diskBudget.load();
+}
+
+TTSSegmentStore::EvictionStats TTSSegmentStore::getEvictionStats() const {
+    EvictionStats stats;
+    stats.evictedEntries = evictedEntries.load();
+    stats.evictedBytes = evictedBytes.load();
+    stats.reclaimedBytes = reclaimedBytes.load();
+    stats.passes = evictionPasses.load();
+    stats.reclaimNanos = reclaimNanos.load();
+    return stats;
+}
+
+bool TTSSegmentStore::overBudget() {
+    uint64_t budget = m_diskBudget.load(std::memory_order_relaxed);
+    if (budget && diskBytes.load(std::memory_order_relaxed) > budget) return true;
+    uint64_t minFree = m_minFreeBytes.load(std::memory_order_relaxed);
+    if (minFree) {
+        std::error_code ec;
+        auto space = std::filesystem::space(m_directory, ec);
+        if (!ec && space.available < minFree) return true;
+    }
+    return false;
+}
+
+void TTSSegmentStore::requestEviction() {
+    if (!m_diskBudget.load(std::memory_order_relaxed)) return;
+    {
+        std::lock_guard<std::mutex> lock(maintenanceMutex);
+        evictionRequested = true;
+    }
+    maintenanceCV.notify_one();
+}
+
+// One sealed segment per pass, oldest first, so lookups only ever wait on single index updates
+void TTSSegmentStore::evictToBudget() {
+    while (overBudget()) {
+        {
+            std::lock_guard<std::mutex> lock(maintenanceMutex);
+            if (stopMaintenance) return;
+        }
+        std::shared_ptr<Segment> victim;
+        {
+            std::shared_lock<std::shared_mutex> lock(indexMutex);
+            for (const auto& [id, segment] : segments) {
+                if (segment != activeSegment) {
+                    victim = segment;
+                    break;
+                }
+            }
+        }
+        if (!victim) {
+            // Only the active segment is left; it is sealed (and evictable) once it fills
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t size = victim->size, copiedBytes = 0;
+        if (!rewriteSegment(victim, true, copiedBytes)) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        reclaimedBytes.fetch_add(size - copiedBytes, std::memory_order_relaxed);
+        evictionPasses.fetch_add(1, std::memory_order_relaxed);
+        reclaimNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    }
+}
+
+uint64_t TTSSegmentStore::totalBytes() {
+    return diskBytes.load();
+}
+
+uint64_t TTSSegmentStore::liveBytes() {
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    uint64_t total = 0;
+    for (const auto& [id, segment] : segments) total += segment->liveBytes;
+    return total;
+}
+
+bool TTSSegmentStore::isIndexLoaded() const {
+    return indexLoaded.load();
+}
+
+size_t TTSSegmentStore::entryCount() {
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return index.size();
+}
+
+// Delete <sha256>.raw files of the one-file-per-phrase layout. They are keyed by SHA-256 of
+// vendor, voice and text, which no lookup produces since keys became MurmurHash3 over the
+// normalized tuple, so importing them would only add records nothing can read.
+void TTSSegmentStore::removeLegacyFiles() {
+    std::error_code ec;
+    size_t removed = 0;
+    uint64_t removedBytes = 0;
+    for (std::filesystem::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec)) {
+        const auto& path = it->path();
+        if (path.extension() != ".raw") continue;
+        std::error_code fileError;
+        uint64_t size = std::filesystem::file_size(path, fileError);
+        if (!std::filesystem::remove(path, fileError)) continue;
+        ++removed;
+        if (size != static_cast<uint64_t>(-1)) removedBytes += size;
+
+        std::lock_guard<std::mutex> lock(maintenanceMutex);
+        if (stopMaintenance) break;
+    }
+    if (removed) {
+        std::cerr << "Removed " << removed << " legacy cache files (" << removedBytes
+                  << " bytes) that current cache keys cannot address" << std::endl;
+    }
+}
+
+void TTSSegmentStore::maintenanceThread() {
+    pthread_setname_np(pthread_self(), "TTSSegmentStore");
+    loadIndex();
+    if (!indexLoaded) return;
+    removeLegacyFiles();
+    std::unique_lock<std::mutex> lock(maintenanceMutex);
+    while (!stopMaintenance) {
+        maintenanceCV.wait_for(lock, kMaintenanceInterval, [this] { return stopMaintenance || evictionRequested; });
+        if (stopMaintenance) break;
+        evictionRequested = false;
+        lock.unlock();
+        evictToBudget();
+        compact();
+        lock.lock();
+    }
+}
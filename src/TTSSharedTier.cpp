@@ -0,0 +1,306 @@
+#include "TTSSharedTier.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kArenaMagic = 0x53535454; // "TTSS" little-endian
+constexpr uint32_t kArenaVersion = 1;
+constexpr uint64_t kRecordAlignment = 64;
+constexpr uint64_t kBytesPerSlot = 16 * 1024;   // index sized for ~16 KB of audio per entry
+constexpr uint64_t kMinSlots = 4096;
+constexpr uint64_t kMaxProbes = 16;
+constexpr int kMaxReadRetries = 64;
+constexpr auto kAttachTimeout = std::chrono::seconds(2);
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory index needs lock-free 64-bit atomics");
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+uint64_t fnv1a64(const std::string& text, uint64_t basis) {
+    uint64_t hash = basis;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// TTSCache keys are already 128-bit hashes in hex; anything else is hashed. {0, 0} marks an empty slot.
+void keyDigest(const std::string& key, uint64_t& high, uint64_t& low) {
+    high = low = 0;
+    bool hex = key.size() == 32;
+    for (size_t i = 0; hex && i < 32; ++i) {
+        int value = hexValue(key[i]);
+        if (value < 0) {
+            hex = false;
+            break;
+        }
+        (i < 16 ? high : low) = ((i < 16 ? high : low) << 4) | static_cast<uint64_t>(value);
+    }
+    if (!hex) {
+        high = fnv1a64(key, 0xcbf29ce484222325ull);
+        low = fnv1a64(key, 0x84222325cbf29ce4ull);
+    }
+    if (high == 0 && low == 0) low = 1;
+}
+
+} // namespace
+
+struct TTSSharedTier::Header {
+    std::atomic<uint32_t> ready;  // kArenaMagic once the creator has initialised the arena
+    uint32_t version;
+    uint64_t arenaBytes;
+    uint64_t slotCount;           // power of two
+    uint64_t slotsOffset;
+    uint64_t dataOffset;
+    uint64_t dataBytes;
+    pthread_mutex_t insertMutex;  // robust, process-shared
+    std::atomic<uint64_t> writeCursor;  // total bytes ever reserved in the ring; only grows
+    std::atomic<uint64_t> inserts;
+};
+
+struct TTSSharedTier::Slot {
+    std::atomic<uint64_t> sequence;  // odd while an insert rewrites the slot
+    std::atomic<uint64_t> keyHigh;
+    std::atomic<uint64_t> keyLow;
+    std::atomic<uint64_t> position;  // ring position (cursor value) of the record
+    std::atomic<uint64_t> length;    // 0 = no valid record
+};
+
+TTSSharedTier::TTSSharedTier(const std::string& name, size_t arenaBytes) : m_name(name) {
+    bool creator = true;
+    m_fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m_fd < 0 && errno == EEXIST) {
+        creator = false;
+        m_fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if (m_fd < 0) {
+        throw std::runtime_error("Failed to open shared cache arena " + name + ": " + std::strerror(errno));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + kAttachTimeout;
+    uint64_t slotCount = kMinSlots;
+    while (slotCount < arenaBytes / kBytesPerSlot) slotCount <<= 1;
+    uint64_t slotsOffset = alignUp(sizeof(Header), 4096);
+    uint64_t dataOffset = alignUp(slotsOffset + slotCount * sizeof(Slot), 4096);
+    if (creator) {
+        if (arenaBytes < dataOffset + 16 * kRecordAlignment) {
+            ::close(m_fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Shared cache arena " + name + " is too small");
+        }
+        if (::ftruncate(m_fd, static_cast<off_t>(arenaBytes)) != 0) {
+            int error = errno;
+            ::close(m_fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to size shared cache arena " + name + ": " + std::strerror(error));
+        }
+        m_arenaBytes = arenaBytes;
+    } else {
+        // The creator may not have sized it yet
+        struct stat st {};
+        while (::fstat(m_fd, &st) == 0 && static_cast<size_t>(st.st_size) < sizeof(Header) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        m_arenaBytes = static_cast<size_t>(st.st_size);
+        if (m_arenaBytes < sizeof(Header)) {
+            ::close(m_fd);
+            throw std::runtime_error("Shared cache arena " + name + " was never initialised");
+        }
+    }
+
+    void* writable = ::mmap(nullptr, m_arenaBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    void* readable = ::mmap(nullptr, m_arenaBytes, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (writable == MAP_FAILED || readable == MAP_FAILED) {
+        int error = errno;
+        if (writable != MAP_FAILED) ::munmap(writable, m_arenaBytes);
+        if (readable != MAP_FAILED) ::munmap(readable, m_arenaBytes);
+        ::close(m_fd);
+        throw std::runtime_error("Failed to map shared cache arena " + name + ": " + std::strerror(error));
+    }
+    m_writable = static_cast<uint8_t*>(writable);
+    m_readable = static_cast<const uint8_t*>(readable);
+    m_header = reinterpret_cast<Header*>(m_writable);
+
+    if (creator) {
+        // ftruncate zero-filled the arena: every slot is empty and the cursor is 0
+        Header* header = m_header;
+        header->version = kArenaVersion;
+        header->arenaBytes = m_arenaBytes;
+        header->slotCount = slotCount;
+        header->slotsOffset = slotsOffset;
+        header->dataOffset = dataOffset;
+        header->dataBytes = (m_arenaBytes - dataOffset) / kRecordAlignment * kRecordAlignment;
+
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->insertMutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        header->ready.store(kArenaMagic, std::memory_order_release);
+    } else {
+        while (m_header->ready.load(std::memory_order_acquire) != kArenaMagic &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (m_header->ready.load(std::memory_order_acquire) != kArenaMagic || m_header->version != kArenaVersion ||
+            m_header->arenaBytes != m_arenaBytes) {
+            ::munmap(m_writable, m_arenaBytes);
+            ::munmap(const_cast<uint8_t*>(m_readable), m_arenaBytes);
+            ::close(m_fd);
+            throw std::runtime_error("Shared cache arena " + name + " has an incompatible layout; shm_unlink it");
+        }
+    }
+    std::cerr << "TTS shared cache tier " << name << (creator ? " created" : " attached") << ": "
+              << (m_header->dataBytes >> 20) << " MB ring, " << m_header->slotCount << " slots" << std::endl;
+}
+
+TTSSharedTier::~TTSSharedTier() {
+    ::munmap(m_writable, m_arenaBytes);
+    ::munmap(const_cast<uint8_t*>(m_readable), m_arenaBytes);
+    ::close(m_fd);
+}
+
+TTSSharedTier::Slot* TTSSharedTier::slotFor(uint8_t* base, uint64_t index) const {
+    return reinterpret_cast<Slot*>(base + m_header->slotsOffset) + (index & (m_header->slotCount - 1));
+}
+
+uint64_t TTSSharedTier::insertCount() const {
+    return m_header->inserts.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const std::vector<uint8_t>> TTSSharedTier::read(const std::string& key) {
+    uint64_t high, low;
+    keyDigest(key, high, low);
+    const Header* header = reinterpret_cast<const Header*>(m_readable);
+    const uint8_t* ring = m_readable + header->dataOffset;
+    uint64_t dataBytes = header->dataBytes;
+
+    for (uint64_t probe = 0; probe < kMaxProbes; ++probe) {
+        Slot* slot = slotFor(const_cast<uint8_t*>(m_readable), high + probe);
+        uint64_t keyHigh = 0, keyLow = 0, position = 0, length = 0;
+        bool consistent = false;
+        for (int attempt = 0; attempt < kMaxReadRetries && !consistent; ++attempt) {
+            uint64_t before = slot->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            keyHigh = slot->keyHigh.load(std::memory_order_relaxed);
+            keyLow = slot->keyLow.load(std::memory_order_relaxed);
+            position = slot->position.load(std::memory_order_relaxed);
+            length = slot->length.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            consistent = slot->sequence.load(std::memory_order_relaxed) == before;
+        }
+        if (!consistent) return nullptr;           // a writer died mid-update; recovered on the next insert
+        if (keyHigh == 0 && keyLow == 0) return nullptr;  // slots are never emptied, so the chain ends here
+        if (keyHigh != high || keyLow != low) continue;
+        if (length == 0 || header->writeCursor.load(std::memory_order_acquire) > position + dataBytes) return nullptr;
+
+        auto audio = std::make_shared<std::vector<uint8_t>>(ring + position % dataBytes,
+                                                            ring + position % dataBytes + length);
+        // The writer advances the cursor before overwriting, so a record lapped during the copy shows here
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->writeCursor.load(std::memory_order_relaxed) > position + dataBytes) {
+            m_tornReads.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return audio;
+    }
+    return nullptr;
+}
+
+bool TTSSharedTier::insert(const std::string& key, const uint8_t* data, size_t size) {
+    Header* header = m_header;
+    uint64_t dataBytes = header->dataBytes;
+    if (size == 0 || size > dataBytes / 8) return false;
+    uint64_t high, low;
+    keyDigest(key, high, low);
+
+    int rc = pthread_mutex_lock(&header->insertMutex);
+    if (rc == EOWNERDEAD) {
+        recoverAfterOwnerDeath();
+        pthread_mutex_consistent(&header->insertMutex);
+    } else if (rc != 0) {
+        std::cerr << "Failed to lock shared cache arena " << m_name << ": " << std::strerror(rc) << std::endl;
+        return false;
+    }
+
+    uint64_t cursor = header->writeCursor.load(std::memory_order_relaxed);
+    // Same key, else the first empty or lapped slot, else the oldest record in the probe window
+    Slot* target = nullptr;
+    Slot* oldest = nullptr;
+    for (uint64_t probe = 0; probe < kMaxProbes && !target; ++probe) {
+        Slot* slot = slotFor(m_writable, high + probe);
+        uint64_t keyHigh = slot->keyHigh.load(std::memory_order_relaxed);
+        uint64_t keyLow = slot->keyLow.load(std::memory_order_relaxed);
+        uint64_t position = slot->position.load(std::memory_order_relaxed);
+        bool empty = keyHigh == 0 && keyLow == 0;
+        bool lapped = slot->length.load(std::memory_order_relaxed) == 0 || cursor > position + dataBytes;
+        if ((keyHigh == high && keyLow == low) || empty || lapped) {
+            target = slot;
+        } else if (!oldest || position < oldest->position.load(std::memory_order_relaxed)) {
+            oldest = slot;
+        }
+    }
+    if (!target) target = oldest;
+
+    // Records never straddle the end of the ring
+    uint64_t position = cursor;
+    if (position % dataBytes + size > dataBytes) position += dataBytes - position % dataBytes;
+    uint64_t next = alignUp(position + size, kRecordAlignment);
+    header->writeCursor.store(next, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_writable + header->dataOffset + position % dataBytes, data, size);
+
+    uint64_t sequence = target->sequence.load(std::memory_order_relaxed);
+    target->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    target->keyHigh.store(high, std::memory_order_relaxed);
+    target->keyLow.store(low, std::memory_order_relaxed);
+    target->position.store(position, std::memory_order_relaxed);
+    target->length.store(size, std::memory_order_relaxed);
+    target->sequence.store(sequence + 2, std::memory_order_release);
+    header->inserts.fetch_add(1, std::memory_order_relaxed);
+
+    pthread_mutex_unlock(&header->insertMutex);
+    return true;
+}
+
+// A process died holding the insert lock: a slot it was rewriting is left with an odd sequence.
+// Invalidate those (keeping the key so probe chains stay intact) and make them readable again.
+void TTSSharedTier::recoverAfterOwnerDeath() {
+    std::cerr << "Recovering shared cache arena " << m_name << " after a writer died" << std::endl;
+    for (uint64_t i = 0; i < m_header->slotCount; ++i) {
+        Slot* slot = slotFor(m_writable, i);
+        uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+        if (sequence & 1) {
+            slot->length.store(0, std::memory_order_relaxed);
+            slot->sequence.store(sequence + 1, std::memory_order_release);
+        }
+    }
+}
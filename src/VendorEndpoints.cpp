@@ -0,0 +1,26 @@
+#include "VendorEndpoints.h"
+
+#include <cstdlib>
+
+namespace {
+
+std::string fromEnvironment(const char* variable, const char* fallback) {
+    const char* value = std::getenv(variable);
+    std::string url = (value && *value) ? value : fallback;
+    while (!url.empty() && url.back() == '/') url.pop_back();
+    return url;
+}
+
+} // namespace
+
+std::string VendorEndpoints::Deepgram() {
+    return fromEnvironment("VOICEKIT_DEEPGRAM_URL", "wss://api.deepgram.com");
+}
+
+std::string VendorEndpoints::ElevenlabsStream() {
+    return fromEnvironment("VOICEKIT_ELEVENLABS_URL", "wss://api.elevenlabs.io");
+}
+
+std::string VendorEndpoints::ElevenlabsApi() {
+    return fromEnvironment("VOICEKIT_ELEVENLABS_API_URL", "https://api.elevenlabs.io");
+}
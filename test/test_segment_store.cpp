@@ -0,0 +1,217 @@
+#include "TTSSegmentStore.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Round-trips the on-disk format of TTSSegmentStore in a temporary directory: reopen,
+// torn-tail and CRC recovery, compaction, eviction to budget, and writes racing the
+// background index load. Needs no credentials or network.
+
+namespace fs = std::filesystem;
+
+static constexpr uint64_t kHeaderBytes = 16;  // RecordHeader
+
+static void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        std::exit(1);
+    }
+}
+
+static std::vector<uint8_t> makeAudio(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> audio(size);
+    for (auto& b : audio) b = static_cast<uint8_t>(rng());
+    return audio;
+}
+
+static bool holds(TTSSegmentStore& store, const std::string& key, const std::vector<uint8_t>& expected) {
+    CachedAudio audio = store.read(key);
+    return audio.size() == expected.size() && audio.toVector() == expected;
+}
+
+static void waitForIndex(TTSSegmentStore& store) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!store.isIndexLoaded() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    Check(store.isIndexLoaded(), "index loads within 10s");
+}
+
+template <typename Predicate>
+static bool waitUntil(Predicate&& predicate, std::chrono::seconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static fs::path lastSegment(const fs::path& directory) {
+    fs::path last;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        if (entry.path().extension() == ".dat" && fs::file_size(entry.path()) > 0 && entry.path() > last) {
+            last = entry.path();
+        }
+    }
+    return last;
+}
+
+static void TestReopen(const fs::path& directory) {
+    std::vector<uint8_t> raw = makeAudio(4000, 1);
+    std::vector<uint8_t> silence(16000, 0);
+    {
+        TTSSegmentStore store(directory.string());
+        waitForIndex(store);
+        Check(store.append("raw", raw.data(), raw.size()), "append raw record");
+        store.setCompression(TTSSegmentStore::Codec::Zlib);
+        Check(store.append("silence", silence.data(), silence.size()), "append compressed record");
+        Check(store.getCompressionStats().compressedEntries == 1, "silence is stored compressed");
+        Check(holds(store, "raw", raw) && holds(store, "silence", silence), "records read back before reopen");
+        Check(store.read("missing").empty(), "unknown key misses");
+    }
+    TTSSegmentStore store(directory.string());
+    waitForIndex(store);
+    Check(store.entryCount() == 2, "both records indexed after reopen");
+    Check(holds(store, "raw", raw) && holds(store, "silence", silence), "records read back after reopen");
+}
+
+static void TestTornTail(const fs::path& directory) {
+    std::vector<std::vector<uint8_t>> audio;
+    {
+        TTSSegmentStore store(directory.string());
+        waitForIndex(store);
+        for (uint32_t i = 0; i < 3; ++i) {
+            audio.push_back(makeAudio(1000, 100 + i));
+            Check(store.append("k" + std::to_string(i), audio[i].data(), audio[i].size()), "append record " + std::to_string(i));
+        }
+    }
+    fs::path segment = lastSegment(directory);
+    uint64_t recordBytes = kHeaderBytes + 2 + 1000;
+    uint64_t intact = fs::file_size(segment);
+    Check(intact == 3 * recordBytes, "segment holds three records");
+
+    // Flip the last payload byte of k2, then append half a header as a crash mid-write would
+    {
+        std::fstream file(segment, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(intact - 1));
+        char last = static_cast<char>(file.get());
+        file.seekp(static_cast<std::streamoff>(intact - 1));
+        file.put(static_cast<char>(last ^ 0x5a));
+        file.seekp(0, std::ios::end);
+        file.write("TTSR\x02\x00\x00", 7);
+    }
+
+    TTSSegmentStore store(directory.string());
+    waitForIndex(store);
+    Check(holds(store, "k0", audio[0]) && holds(store, "k1", audio[1]), "records before the damage survive");
+    Check(store.read("k2").empty(), "record with a bad CRC is dropped");
+    Check(fs::file_size(segment) == 2 * recordBytes, "torn tail is truncated on reopen");
+    Check(store.totalBytes() == 2 * recordBytes, "disk bytes exclude the dropped tail");
+}
+
+static void TestCompaction(const fs::path& directory) {
+    constexpr uint64_t kSegmentBytes = 64 * 1024;
+    constexpr int kKeys = 40;
+    std::vector<std::vector<uint8_t>> latest(kKeys);
+    TTSSegmentStore store(directory.string(), kSegmentBytes);
+    waitForIndex(store);
+    for (int i = 0; i < kKeys; ++i) {
+        latest[i] = makeAudio(8000, 200 + i);
+        Check(store.append("key" + std::to_string(i), latest[i].data(), latest[i].size()), "append first version");
+    }
+    // Rewriting most keys leaves the first segments mostly dead
+    for (int i = 0; i < kKeys; ++i) {
+        if (i % 5 == 0) continue;
+        latest[i] = makeAudio(8000, 300 + i);
+        Check(store.append("key" + std::to_string(i), latest[i].data(), latest[i].size()), "append second version");
+    }
+    uint64_t before = store.totalBytes();
+    Check(store.liveBytes() < before, "rewrites leave dead records");
+
+    uint64_t reclaimed = store.compact();
+    Check(reclaimed > 0, "compaction reclaims dead records");
+    Check(store.totalBytes() == before - reclaimed, "disk bytes drop by what was reclaimed");
+    Check(store.entryCount() == kKeys, "compaction keeps every key");
+    for (int i = 0; i < kKeys; ++i) {
+        Check(holds(store, "key" + std::to_string(i), latest[i]), "latest version of key" + std::to_string(i) + " after compaction");
+    }
+}
+
+static void TestEviction(const fs::path& directory) {
+    constexpr uint64_t kBudget = 4ull << 20;
+    constexpr int kKeys = 80;
+    constexpr size_t kAudioBytes = 100 * 1024;
+    TTSSegmentStore store(directory.string());
+    waitForIndex(store);
+    store.setDiskBudget(kBudget, 0);
+    std::vector<uint8_t> newest;
+    for (int i = 0; i < kKeys; ++i) {
+        std::vector<uint8_t> audio = makeAudio(kAudioBytes, 400 + i);
+        Check(store.append("clip" + std::to_string(i), audio.data(), audio.size()), "append clip " + std::to_string(i));
+        newest = std::move(audio);
+    }
+    Check(waitUntil([&] { return store.totalBytes() <= kBudget; }, std::chrono::seconds(10)),
+          "store shrinks to its budget");
+    auto stats = store.getEvictionStats();
+    Check(stats.evictedEntries > 0 && stats.passes > 0, "eviction dropped entries");
+    Check(store.read("clip0").empty(), "oldest clip is evicted");
+    Check(holds(store, "clip" + std::to_string(kKeys - 1), newest), "newest clip survives eviction");
+    Check(store.entryCount() + stats.evictedEntries == kKeys, "every clip is either indexed or evicted");
+}
+
+static void TestSaveDuringIndexLoad(const fs::path& directory) {
+    constexpr int kKeys = 200;
+    std::vector<uint8_t> old = makeAudio(2000, 500);
+    {
+        TTSSegmentStore store(directory.string(), 64 * 1024);
+        waitForIndex(store);
+        for (int i = 0; i < kKeys; ++i) {
+            Check(store.append("phrase" + std::to_string(i), old.data(), old.size()), "append before reopen");
+        }
+    }
+    std::vector<uint8_t> fresh = makeAudio(2000, 501);
+    TTSSegmentStore store(directory.string(), 64 * 1024);
+    // Saved while the scan may still be running; the scan must not bring back the old audio
+    Check(store.append("phrase0", fresh.data(), fresh.size()), "append during index load");
+    Check(holds(store, "phrase0", fresh), "new record is readable at once");
+    waitForIndex(store);
+    Check(holds(store, "phrase0", fresh), "new record wins over the scanned one");
+    Check(holds(store, "phrase" + std::to_string(kKeys - 1), old), "scanned records are readable");
+    Check(store.entryCount() == kKeys, "no key is indexed twice");
+}
+
+int main() {
+    std::string pattern = (fs::temp_directory_path() / "voicekit-store-XXXXXX").string();
+    Check(mkdtemp(pattern.data()) != nullptr, "create a temporary directory");
+    fs::path root = pattern;
+
+    struct Case {
+        const char* name;
+        void (*run)(const fs::path&);
+    } cases[] = {
+        {"reopen", TestReopen},
+        {"torn_tail", TestTornTail},
+        {"compaction", TestCompaction},
+        {"eviction", TestEviction},
+        {"save_during_index_load", TestSaveDuringIndexLoad},
+    };
+    for (const auto& testCase : cases) {
+        fs::path directory = root / testCase.name;
+        testCase.run(directory);
+        std::cout << testCase.name << ": ok\n";
+    }
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    std::cout << "All segment store checks passed!\n";
+    return 0;
+}
@@ -1,13 +1,20 @@
 #include "STTFactory.h"
 #include "TTSFactory.h"
 #include <iostream>
-#include <cassert>
 #include <fstream>
 #include <vector>
 #include <cstdlib>
 #include <thread>
 #include <chrono>
 
+// Unlike assert, survives NDEBUG builds and makes ctest see the failure
+static void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        std::exit(1);
+    }
+}
+
 void TestMicrosoftTTS() {
     const char* key = std::getenv("SPEECH_KEY");
     const char* region = std::getenv("SPEECH_REGION");
@@ -17,10 +24,7 @@ void TestMicrosoftTTS() {
     }
 
     std::ofstream outFile("8KHz16BitMonoRAWGeneratedAudio.raw", std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Failed to open file for writing." << "\n";
-        return;
-    }
+    Check(static_cast<bool>(outFile), "open 8KHz16BitMonoRAWGeneratedAudio.raw for writing");
 
     std::shared_ptr<I_TTSModule> tts = TTSFactory::CreateTTSModule("Microsoft", "test_session", [&](const std::vector<uint8_t>& audioData) {
         std::cout << "Audio data size : " << audioData.size() << "\n";
@@ -35,9 +39,12 @@ void TestMicrosoftTTS() {
 
     tts->Initialise(key, region);
 
-    tts->Speak("Hi! How are you? Hello World!");
-    
-    std::this_thread::sleep_for(std::chrono::seconds(20));
+    SpeakHandle speech = tts->Speak("Hi! How are you? Hello World!");
+
+    // Resolves after the last chunk (and the empty end marker) reached the callback
+    Check(speech.done.waitFor(std::chrono::seconds(60)), "playout finishes within 60s");
+    Check(speech.firstAudio.get(), "audio was played");
+    Check(speech.done.get() == SpeakOutcome::Completed, "speech completed");
 }
 
 
@@ -50,10 +57,7 @@ void TestDeepgramTTS() {
     }
 
     std::ofstream outFile("8KHz16BitMonoRAWGeneratedAudio.raw", std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Failed to open file for writing." << "\n";
-        return;
-    }
+    Check(static_cast<bool>(outFile), "open 8KHz16BitMonoRAWGeneratedAudio.raw for writing");
 
     std::shared_ptr<I_TTSModule> tts = TTSFactory::CreateTTSModule("Deepgram", "test_session", [&](const std::vector<uint8_t>& audioData) {
         std::cout << "Audio data size : " << audioData.size() << "\n";
@@ -68,9 +72,12 @@ void TestDeepgramTTS() {
 
     tts->Initialise(key, region);
 
-    tts->Speak("Hi! How are you? What is plan for this weekend? Do you want to go outside somewhere near by to bangalore?");
-    
-    std::this_thread::sleep_for(std::chrono::seconds(20));
+    SpeakHandle speech = tts->Speak("Hi! How are you? What is plan for this weekend? Do you want to go outside somewhere near by to bangalore?");
+
+    // Resolves after the last chunk (and the empty end marker) reached the callback
+    Check(speech.done.waitFor(std::chrono::seconds(60)), "playout finishes within 60s");
+    Check(speech.firstAudio.get(), "audio was played");
+    Check(speech.done.get() == SpeakOutcome::Completed, "speech completed");
 }
 
 
@@ -83,7 +90,7 @@ void TestDeepgramSTT() {
     }
 
     std::shared_ptr<I_STTModule> stt = STTFactory::CreateSTTModule("Deepgram", "test_session", [&](std::string& text) {
-        assert(!text.empty());
+        Check(!text.empty(), "recognised text is not empty");
         std::cout << "Test Recognized: " << text << "\n";
         stt->StopRecognition();
     }, "en-US");
@@ -94,16 +101,14 @@ void TestDeepgramSTT() {
 
     std::cout << "StartRecognition" << "\n";
 
+    Completion<std::string> utterance = stt->NextUtterance();
     stt->StartRecognition();
 
     std::cout << "audioFile " << "\n";
 
     // This is hello world test with counting from 1 to 10. 1 2 3 4 5 6 7 8 9 10. 
     std::ifstream audioFile("8KHz16BitMonoRawAudioSample.raw", std::ios::binary);
-    if (!audioFile) {
-        std::cerr << "Failed to open audio file.\n";
-        return;
-    }
+    Check(static_cast<bool>(audioFile), "open 8KHz16BitMonoRawAudioSample.raw");
 
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -119,7 +124,8 @@ void TestDeepgramSTT() {
         stt->StreamAudioData(buffer);
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(20));
+    Check(utterance.waitFor(std::chrono::seconds(20)), "final transcript within 20s");
+    Check(!utterance.get().empty(), "transcript is not empty");
 }
 
 void TestMicrosoftSTT() {
@@ -131,7 +137,7 @@ void TestMicrosoftSTT() {
     }
 
     std::shared_ptr<I_STTModule> stt = STTFactory::CreateSTTModule("Microsoft", "test_session", [&](std::string& text) {
-        assert(!text.empty());
+        Check(!text.empty(), "recognised text is not empty");
         std::cout << "Test Recognized: " << text << "\n";
         stt->StopRecognition();
     }, "en-US");
@@ -142,16 +148,14 @@ void TestMicrosoftSTT() {
 
     std::cout << "StartRecognition" << "\n";
 
+    Completion<std::string> utterance = stt->NextUtterance();
     stt->StartRecognition();
 
     std::cout << "audioFile " << "\n";
 
     // This is hello world test with counting from 1 to 10. 1 2 3 4 5 6 7 8 9 10. 
     std::ifstream audioFile("8KHz16BitMonoRawAudioSample.raw", std::ios::binary);
-    if (!audioFile) {
-        std::cerr << "Failed to open audio file.\n";
-        return;
-    }
+    Check(static_cast<bool>(audioFile), "open 8KHz16BitMonoRawAudioSample.raw");
 
     std::vector<unsigned char> buffer(320);
     while (audioFile.read(reinterpret_cast<char*>(buffer.data()), buffer.size())) {
@@ -165,7 +169,8 @@ void TestMicrosoftSTT() {
         stt->StreamAudioData(buffer);
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(20));
+    Check(utterance.waitFor(std::chrono::seconds(20)), "final transcript within 20s");
+    Check(!utterance.get().empty(), "transcript is not empty");
 }
 
 void TestElevenlabsTTS() {
@@ -177,10 +182,7 @@ void TestElevenlabsTTS() {
     }
 
     std::ofstream outFile("8KHz16BitMonoRAWGeneratedAudio.raw", std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Failed to open file for writing." << "\n";
-        return;
-    }
+    Check(static_cast<bool>(outFile), "open 8KHz16BitMonoRAWGeneratedAudio.raw for writing");
 
     std::shared_ptr<I_TTSModule> tts = TTSFactory::CreateTTSModule("Elevenlabs", "test_session", [&](const std::vector<uint8_t>& audioData) {
         std::cout << "Audio data size : " << audioData.size() << "\n";
@@ -195,9 +197,12 @@ void TestElevenlabsTTS() {
 
     tts->Initialise(key, region);
 
-    tts->Speak("Hi! How are you? What is plan for this weekend? Do you want to go outside somewhere near by to bangalore?");
-    
-    std::this_thread::sleep_for(std::chrono::seconds(20));
+    SpeakHandle speech = tts->Speak("Hi! How are you? What is plan for this weekend? Do you want to go outside somewhere near by to bangalore?");
+
+    // Resolves after the last chunk (and the empty end marker) reached the callback
+    Check(speech.done.waitFor(std::chrono::seconds(60)), "playout finishes within 60s");
+    Check(speech.firstAudio.get(), "audio was played");
+    Check(speech.done.get() == SpeakOutcome::Completed, "speech completed");
 }
 
 int main() {